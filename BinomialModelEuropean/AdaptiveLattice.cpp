@@ -0,0 +1,71 @@
+#include "AdaptiveLattice.hpp"
+#include "PayoffShape.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+double AdaptiveLattice::Price(Option& Opt, BinModel Model, bool American)
+{
+    Kinks = Extra;
+    PayoffShape Shape;
+    if (GetPayoffShape(Opt, Shape) == 0)
+        Kinks.insert(Kinks.end(), Shape.Breaks.begin(), Shape.Breaks.end());
+    sort(Kinks.begin(), Kinks.end());
+    Nodes = 0;
+    int Level = Kinks.empty() || Model.HasDividends() ? 0 : Levels;
+    return Induct(Opt, Model, Opt.GetN(), American, Level);
+}
+
+double AdaptiveLattice::Induct(Option& Opt, BinModel Model, int N, bool American, int Level)
+{
+    int K = Steps;
+    double q = Model.RiskNeutProb();
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    vector<double> Price(N + 1), Stock(N + 1), ExVal(N + 1);
+    INSTR_COUNT(Allocations, 3);
+    Model.SLayer(N, Stock.data());
+    Opt.PayoffBatch(Stock.data(), Price.data(), N + 1);
+    INSTR_COUNT(PayoffEvals, N + 1);
+
+    // the sub-lattice model: Substeps steps with the drift and variance in
+    // log price of one coarse step
+    int m = Substeps;
+    double a = log(1 + Model.GetU()), b = log(1 + Model.GetD());
+    double Drift = (a + b) / 2 / m, Half = (a - b) / 2 / sqrt((double)m);
+    double Uf = exp(Drift + Half) - 1, Df = exp(Drift - Half) - 1;
+    double Rf = pow(1 + Model.GetR(), 1.0 / m) - 1;
+    bool Graft = Level > 0 && N > K && Df < Rf && Rf < Uf;
+
+    for (int n = N - 1; n >= 0; n--)
+    {
+        for (int i = 0; i <= n; i++)
+            Price[i] = Up * Price[i + 1] + Down * Price[i];
+        Nodes += n + 1;
+        if (American || (Graft && n == N - K))
+            Model.SLayer(n, Stock.data());
+        if (American)
+        {
+            Opt.PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+            for (int i = 0; i <= n; i++)
+                Price[i] = max(Price[i], ExVal[i]);
+            INSTR_COUNT(PayoffEvals, n + 1);
+        }
+        if (!Graft || n != N - K)
+            continue;
+        // nodes that can reach a kink within K+1 steps
+        double Lo = pow(1 + Model.GetD(), K + 1), Hi = pow(1 + Model.GetU(), K + 1);
+        for (int i = 0; i <= n; i++)
+        {
+            vector<double>::iterator k = lower_bound(Kinks.begin(), Kinks.end(), Stock[i] * Lo);
+            if (k == Kinks.end() || *k > Stock[i] * Hi)
+                continue;
+            BinModel Fine;
+            Fine.SetData(Stock[i], Uf, Df, Rf);
+            Price[i] = Induct(Opt, Fine, K * m, American, Level - 1);
+        }
+    }
+    INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+    return Price[0];
+}
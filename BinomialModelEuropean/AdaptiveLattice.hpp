@@ -0,0 +1,46 @@
+#ifndef AdaptiveLattice_hpp
+#define AdaptiveLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+// Adaptive mesh lattice in the manner of Figlewski and Gao: a coarse
+// tree with fine sub-lattices grafted on where the payoff is not smooth.
+//
+// The kinks and jumps of a library payoff come from its class and
+// strikes; AddLevel() adds others, such as a barrier. At layer N-K, K =
+// SetSteps(), every node that can reach a kink within K+1 steps gets its
+// value from a sub-lattice rooted there that covers the remaining K
+// steps with SetSubsteps() fine steps each. Its spacing in log price is
+// the coarse one over the square root of the substeps, and the same
+// variance per unit of time. The sub-lattice is refined the same way, down
+// to SetLevels() levels. Everything else uses the coarse tree, so the
+// cost is about that of the coarse tree alone. Models with dividends and
+// payoffs without kinks are priced on the plain coarse tree.
+class AdaptiveLattice
+{
+private:
+    int Levels;
+    int Steps;
+    int Substeps;
+    std::vector<double> Extra; // levels added by AddLevel()
+    std::vector<double> Kinks;
+    long long Nodes;
+    // N steps of Model; Opt only supplies the payoff, its own N is left alone
+    double Induct(Option& Opt, BinModel Model, int N, bool American, int Level);
+public:
+    AdaptiveLattice() : Levels(5), Steps(1), Substeps(4), Nodes(0) { }
+    // number of nested refinements, 0 for the plain coarse tree
+    void SetLevels(int Levels_) { Levels = Levels_ < 0 ? 0 : Levels_; }
+    // coarse steps before expiry covered by each sub-lattice
+    void SetSteps(int Steps_) { Steps = Steps_ < 1 ? 1 : Steps_; }
+    // fine steps per coarse step
+    void SetSubsteps(int Substeps_) { Substeps = Substeps_ < 2 ? 2 : Substeps_; }
+    // a further price level to refine around
+    void AddLevel(double Level) { Extra.push_back(Level); }
+    void ClearLevels() { Extra.clear(); }
+    double Price(Option& Opt, BinModel Model, bool American);
+    // nodes visited by the last Price(), all levels together
+    long long GetNodes() { return Nodes; }
+};
+#endif
@@ -0,0 +1,174 @@
+#include "AmericanFastPath.hpp"
+#include "BlackScholes.hpp"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace
+{
+    double NormCdf(double x)
+    {
+        return 0.5 * erfc(-x / sqrt(2.0));
+    }
+
+    double NormPdf(double x)
+    {
+        return exp(-0.5 * x * x) / sqrt(2.0 * M_PI);
+    }
+
+    // Relative error of BAWPut() against the converged lattice price
+    // (Snell at N = 4000 and 4001 averaged), by rT, sigma sqrt(T) and
+    // moneyness ln(K/S) / (sigma sqrt(T)), positive in the money
+    const double RiskRT[] = {0.005, 0.01, 0.02, 0.05, 0.1, 0.2};
+    const double RiskST[] = {0.05, 0.1, 0.2, 0.3, 0.5, 0.8};
+    const double RiskM[] = {-2, -1.5, -1, -0.5, 0, 0.5, 1, 1.5, 2, 3};
+    const double RiskTable[6][6][10] = {
+        {
+            {0.0416, 0.0186, 0.0075, 0.0013, 0.0026, 0.0049, 0.0047, 0.0001, 0.0000, 0.0000},
+            {0.0161, 0.0069, 0.0024, 0.0002, 0.0019, 0.0030, 0.0033, 0.0019, 0.0000, 0.0000},
+            {0.0069, 0.0029, 0.0008, 0.0003, 0.0011, 0.0017, 0.0020, 0.0017, 0.0001, 0.0000},
+            {0.0046, 0.0019, 0.0005, 0.0002, 0.0007, 0.0012, 0.0014, 0.0013, 0.0005, 0.0000},
+            {0.0031, 0.0013, 0.0004, 0.0001, 0.0004, 0.0007, 0.0009, 0.0009, 0.0005, 0.0000},
+            {0.0025, 0.0011, 0.0004, 0.0000, 0.0002, 0.0004, 0.0006, 0.0006, 0.0004, 0.0000},
+        },
+        {
+            {0.1109, 0.0518, 0.0233, 0.0073, 0.0023, 0.0068, 0.0037, 0.0000, 0.0000, 0.0000},
+            {0.0444, 0.0202, 0.0085, 0.0018, 0.0023, 0.0047, 0.0045, 0.0000, 0.0000, 0.0000},
+            {0.0187, 0.0083, 0.0032, 0.0003, 0.0016, 0.0028, 0.0032, 0.0018, 0.0000, 0.0000},
+            {0.0120, 0.0053, 0.0020, 0.0001, 0.0011, 0.0020, 0.0024, 0.0018, 0.0000, 0.0000},
+            {0.0078, 0.0035, 0.0014, 0.0002, 0.0006, 0.0012, 0.0016, 0.0014, 0.0001, 0.0000},
+            {0.0059, 0.0028, 0.0012, 0.0003, 0.0002, 0.0007, 0.0010, 0.0010, 0.0003, 0.0000},
+        },
+        {
+            {0.2639, 0.1258, 0.0584, 0.0206, 0.0012, 0.0082, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.1174, 0.0552, 0.0253, 0.0086, 0.0015, 0.0064, 0.0035, 0.0000, 0.0000, 0.0000},
+            {0.0504, 0.0234, 0.0104, 0.0030, 0.0016, 0.0043, 0.0043, 0.0000, 0.0000, 0.0000},
+            {0.0321, 0.0149, 0.0066, 0.0018, 0.0012, 0.0031, 0.0036, 0.0010, 0.0000, 0.0000},
+            {0.0200, 0.0094, 0.0043, 0.0013, 0.0006, 0.0019, 0.0025, 0.0015, 0.0000, 0.0000},
+            {0.0146, 0.0072, 0.0035, 0.0014, 0.0000, 0.0010, 0.0016, 0.0013, 0.0000, 0.0000},
+        },
+        {
+            {0.4752, 0.2192, 0.0833, 0.0070, 0.0231, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.3472, 0.1672, 0.0782, 0.0280, 0.0004, 0.0075, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.1744, 0.0839, 0.0403, 0.0159, 0.0012, 0.0058, 0.0010, 0.0000, 0.0000, 0.0000},
+            {0.1136, 0.0547, 0.0265, 0.0107, 0.0009, 0.0044, 0.0034, 0.0000, 0.0000, 0.0000},
+            {0.0698, 0.0341, 0.0169, 0.0072, 0.0011, 0.0027, 0.0034, 0.0000, 0.0000, 0.0000},
+            {0.0490, 0.0246, 0.0128, 0.0062, 0.0018, 0.0012, 0.0023, 0.0001, 0.0000, 0.0000},
+        },
+        {
+            {0.1186, 0.0398, 0.1186, 0.1272, 0.0600, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.4969, 0.2316, 0.0908, 0.0115, 0.0208, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.3786, 0.1844, 0.0885, 0.0342, 0.0030, 0.0061, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.2700, 0.1322, 0.0654, 0.0278, 0.0053, 0.0048, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.1723, 0.0854, 0.0436, 0.0202, 0.0056, 0.0026, 0.0015, 0.0000, 0.0000, 0.0000},
+            {0.1199, 0.0610, 0.0325, 0.0165, 0.0061, 0.0004, 0.0020, 0.0000, 0.0000, 0.0000},
+        },
+        {
+            {0.3599, 0.3087, 0.2322, 0.1362, 0.0288, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.1390, 0.0254, 0.1075, 0.1191, 0.0562, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.5397, 0.2561, 0.1057, 0.0205, 0.0161, 0.0000, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.5113, 0.2515, 0.1202, 0.0451, 0.0033, 0.0037, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.3823, 0.1912, 0.0977, 0.0446, 0.0124, 0.0023, 0.0000, 0.0000, 0.0000, 0.0000},
+            {0.2777, 0.1421, 0.0761, 0.0386, 0.0148, 0.0010, 0.0000, 0.0000, 0.0000, 0.0000},
+        }
+    };
+
+    // cell of a grid containing x, -1 outside it; below the grid is the
+    // first cell if Clamp, and so is above it for the last
+    int Cell(const double* Grid, int Size, double x, bool ClampLo, bool ClampHi)
+    {
+        if (x < Grid[0])
+            return ClampLo ? 0 : -1;
+        if (x > Grid[Size - 1])
+            return ClampHi ? Size - 2 : -1;
+        int k = 0;
+        while (k < Size - 2 && x > Grid[k + 1])
+            k++;
+        return k;
+    }
+
+    // largest tabulated error at the corners of the cell of the contract,
+    // infinite outside the table; the error falls with rT and deep in the
+    // money, so those ends are clamped
+    double BAWRisk(double rT, double sT, double m)
+    {
+        int i = Cell(RiskRT, 6, rT, true, false);
+        int j = Cell(RiskST, 6, sT, false, false);
+        int k = Cell(RiskM, 10, m, false, true);
+        if (i < 0 || j < 0 || k < 0)
+            return INFINITY;
+        double Risk = 0.0;
+        for (int a = i; a <= i + 1; a++)
+            for (int b = j; b <= j + 1; b++)
+                for (int c = k; c <= k + 1; c++)
+                    Risk = max(Risk, RiskTable[a][b][c]);
+        return Risk;
+    }
+}
+
+double BAWPut(double S, double K, double r, double Sigma, double T)
+{
+    double s2 = Sigma * Sigma, SqT = Sigma * sqrt(T);
+    double M = 2 * r / s2;
+    double Kq = 1 - exp(-r * T);
+    double q1 = (-(M - 1) - sqrt((M - 1) * (M - 1) + 4 * M / Kq)) / 2;
+    auto D1 = [&](double x) { return (log(x / K) + (r + s2 / 2) * T) / SqT; };
+
+    // critical price S** by Newton's method from the seed of Barone-Adesi
+    // and Whaley
+    double q1Inf = (-(M - 1) - sqrt((M - 1) * (M - 1) + 4 * M)) / 2;
+    double SInf = K / (1 - 1 / q1Inf);
+    double Si = SInf + (K - SInf) * exp((r * T - 2 * SqT) * K / (K - SInf));
+    for (int Iter = 0; Iter < 100; Iter++)
+    {
+        double d1 = D1(Si);
+        double Rhs = BSPut(Si, K, r, Sigma, T) - (1 - NormCdf(-d1)) * Si / q1;
+        if (fabs(K - Si - Rhs) / K < 1e-9)
+            break;
+        double bi = -NormCdf(-d1) * (1 - 1 / q1) - (1 + NormPdf(d1) / SqT) / q1;
+        Si = (K - Rhs + bi * Si) / (1 + bi);
+    }
+    if (S <= Si)
+        return K - S;
+    double A1 = -(Si / q1) * (1 - NormCdf(-D1(Si)));
+    return BSPut(S, K, r, Sigma, T) + A1 * pow(S / Si, q1);
+}
+
+double AmericanFastPath::Price(Option& Opt, BinModel Model)
+{
+    PayoffKind Kind = Opt.GetKind();
+    double R = Model.GetR();
+    EurOption* Eur = dynamic_cast<EurOption*>(&Opt);
+    if (Eur && !Model.HasDividends() &&
+        ((Kind == CallPayoff && R >= 0.0) || (Kind == PutPayoff && R <= 0.0)))
+    {
+        Shortcuts++;
+        return Eur->PriceByExpectation(Model);
+    }
+    AmOption* Am = dynamic_cast<AmOption*>(&Opt);
+    if (!Am)
+        return NAN;
+    if (Kind != PutPayoff || Opt.GetN() < MinSteps || Model.HasDividends())
+    {
+        Fallbacks++;
+        return Am->PriceBySnell(Model);
+    }
+
+    double K, K2;
+    Opt.GetStrikes(K, K2);
+    double q = Model.RiskNeutProb();
+    double a = log(1 + Model.GetU()), b = log(1 + Model.GetD());
+    double Sigma = sqrt(q * (1 - q)) * (a - b);
+    double r = log(1 + R);
+    double T = Opt.GetN();
+    double S0 = Model.GetS0();
+    double SqT = Sigma * sqrt(T);
+    if (!(BAWRisk(r * T, SqT, log(K / S0) / SqT) <= MaxRisk))
+    {
+        Fallbacks++;
+        return Am->PriceBySnell(Model);
+    }
+    double Price = BAWPut(S0, K, r, Sigma, T);
+    Approximations++;
+    return Price;
+}
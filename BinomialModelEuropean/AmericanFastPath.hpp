@@ -0,0 +1,48 @@
+#ifndef AmericanFastPath_hpp
+#define AmericanFastPath_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+// American calls and puts without the lattice where that is safe.
+//
+// A call on a stock without dividends is never exercised early when
+// R >= 0, nor is a put when R <= 0; their American price is the European
+// one, which PriceByExpectation() gives exactly in O(N). Otherwise a put
+// is priced with the Barone-Adesi-Whaley quadratic approximation in units
+// of one step (T = N, r = ln(1+R) and the variance of the log return per
+// step under the risk-neutral measure) if its error is known to be small
+// enough. The error is looked up in a table of BAW against the converged
+// lattice price by rT, sigma sqrt(T) and moneyness ln(K/S0)/(sigma sqrt(T)),
+// taking the largest at the corners of the cell of the contract. If that
+// exceeds MaxRisk, or the contract is off the table (rT above 0.2, sigma
+// sqrt(T) outside 0.05 to 0.8, more than two standard deviations out of
+// the money), or N is below MinSteps, or the payoff is not a put, or the
+// model has dividends, the contract goes to PriceBySnell(). At the default
+// 1% BAW takes puts at least half a standard deviation in the money at any
+// tabulated rT (one at sigma sqrt(T) = 0.1 or rT above 0.1), at-the-money
+// ones only for rT near 0.01 or high volatility, and out-of-the-money ones
+// only for rT near 0.01. A contract that is not an AmOption prices as NaN.
+// Every decision is counted.
+class AmericanFastPath
+{
+private:
+    double MaxRisk;
+    int MinSteps;
+    long long Shortcuts;
+    long long Approximations;
+    long long Fallbacks;
+public:
+    AmericanFastPath() : MaxRisk(0.01), MinSteps(50), Shortcuts(0), Approximations(0), Fallbacks(0) { }
+    void SetMaxRisk(double MaxRisk_) { MaxRisk = MaxRisk_; }
+    void SetMinSteps(int MinSteps_) { MinSteps = MinSteps_; }
+    double Price(Option& Opt, BinModel Model);
+    long long GetShortcuts() { return Shortcuts; }
+    long long GetApproximations() { return Approximations; }
+    long long GetFallbacks() { return Fallbacks; }
+    void ResetCounters() { Shortcuts = Approximations = Fallbacks = 0; }
+};
+
+// Barone-Adesi-Whaley price of an American put with no dividends; r and
+// Sigma per unit of T
+double BAWPut(double S, double K, double r, double Sigma, double T);
+#endif
@@ -0,0 +1,236 @@
+#include "BarrierOption.hpp"
+#include "Instrumentation.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    // European price of the underlying as the O(N) expectation over the
+    // leaves, with binomial weights taken in logs
+    double EurSum(Option& Opt, BinModel& Model)
+    {
+        int N = Opt.GetN();
+        double q = Model.RiskNeutProb();
+        vector<double> Stock(N + 1), Pay(N + 1);
+        Model.SLayer(N, Stock.data());
+        Opt.PayoffBatch(Stock.data(), Pay.data(), N + 1);
+        double LogW = N * log(1 - q) - N * log(1 + Model.GetR());
+        double Step = log(q) - log(1 - q);
+        double Sum = 0.0;
+        for (int i = 0; i <= N; i++)
+        {
+            if (Pay[i] != 0.0)
+                Sum += exp(LogW) * Pay[i];
+            LogW += Step + log((double)(N - i) / (i + 1));
+        }
+        return Sum;
+    }
+}
+
+void BarrierOption::Lines(BinModel& Model, double& Inner, double& Outer, double& w)
+{
+    // in log price the nodes of layer n lie on the lines n(a+b)/2 + k Delta,
+    // which for CRR parameters (a = -b) do not move with n
+    double a = log(1 + Model.GetU()), b = log(1 + Model.GetD());
+    double Delta = (a - b) / 2.0;
+    double h = log(H / Model.GetS0()) / Delta;
+    bool Up = Kind == UpAndOut || Kind == UpAndIn;
+    // otherwise the lines drift with n and no pair of them brackets H on
+    // every layer, so the barrier is checked against H layer by layer
+    bool Fixed = fabs(a + b) <= 1e-12 * (a - b);
+    if (!Aligned || !Fixed)
+    {
+        Inner = Outer = H;
+        w = 1.0;
+        return;
+    }
+    double E = Up ? ceil(h - 1e-9) : floor(h + 1e-9);
+    double I = Up ? E - 1 : E + 1;
+    Outer = Model.GetS0() * exp(E * Delta);
+    Inner = Model.GetS0() * exp(I * Delta);
+    w = 1.0 - fabs(E - h);
+}
+
+double BarrierOption::OutPass(BinModel& Model, double Level, bool American, double* HitOrExpiry)
+{
+    int N = Underlying->GetN();
+    double q = Model.RiskNeutProb();
+    double Disc = 1.0 / (1 + Model.GetR());
+    double a = log(1 + Model.GetU()), b = log(1 + Model.GetD());
+    double x = log(Level / Model.GetS0());
+    bool Up = Kind == UpAndOut || Kind == UpAndIn;
+
+    // live nodes of layer n; the tolerance keeps nodes on the barrier
+    // line knocked out despite rounding
+    auto Lo = [&](int n)
+    {
+        return Up ? 0 : max(0, (int)floor((x - n * b) / (a - b) + 1e-9) + 1);
+    };
+    auto Hi = [&](int n)
+    {
+        return Up ? min(n, (int)ceil((x - n * b) / (a - b) - 1e-9) - 1) : n;
+    };
+
+    vector<double> Price(N + 2), Stock(N + 1), ExVal;
+    vector<double> Hit;
+    if (HitOrExpiry)
+        Hit.assign(N + 2, 1.0);
+    if (American)
+        ExVal.resize(N + 1);
+    INSTR_COUNT(Allocations, 2);
+
+    int lo = Lo(N), hi = Hi(N);
+    if (lo <= hi)
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SRange(N, lo, hi - lo + 1, Stock.data());
+        Underlying->PayoffBatch(Stock.data(), Price.data() + lo, hi - lo + 1);
+        Nodes += hi - lo + 1;
+        INSTR_COUNT(PayoffEvals, hi - lo + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            int PrevLo = lo, PrevHi = hi;
+            lo = Lo(n);
+            hi = Hi(n);
+            if (lo > hi)
+                continue;
+            // knocked-out children pay the rebate
+            int j = lo;
+            for (; j <= hi + 1 && j < PrevLo; j++)
+                Price[j] = Rebate;
+            for (j = max(j, PrevHi + 1); j <= hi + 1; j++)
+                Price[j] = Rebate;
+            for (int i = lo; i <= hi; i++)
+                Price[i] = Disc * (q * Price[i + 1] + (1 - q) * Price[i]);
+            if (HitOrExpiry)
+            {
+                j = lo;
+                for (; j <= hi + 1 && j < PrevLo; j++)
+                    Hit[j] = 1.0;
+                for (j = max(j, PrevHi + 1); j <= hi + 1; j++)
+                    Hit[j] = 1.0;
+                for (int i = lo; i <= hi; i++)
+                    Hit[i] = Disc * (q * Hit[i + 1] + (1 - q) * Hit[i]);
+            }
+            if (American)
+            {
+                Model.SRange(n, lo, hi - lo + 1, Stock.data());
+                Underlying->PayoffBatch(Stock.data(), ExVal.data(), hi - lo + 1);
+                for (int i = lo; i <= hi; i++)
+                    Price[i] = max(Price[i], ExVal[i - lo]);
+                INSTR_COUNT(PayoffEvals, hi - lo + 1);
+            }
+            Nodes += hi - lo + 1;
+            INSTR_COUNT(NodesVisited, hi - lo + 1);
+        }
+    }
+    // the root itself may be knocked out
+    bool RootLive = lo <= hi && lo == 0;
+    if (HitOrExpiry)
+        *HitOrExpiry = RootLive ? Hit[0] : 1.0;
+    return RootLive ? Price[0] : Rebate;
+}
+
+double BarrierOption::AmInPass(BinModel& Model, double Level)
+{
+    int N = Underlying->GetN();
+    double q = Model.RiskNeutProb();
+    double Disc = 1.0 / (1 + Model.GetR());
+    bool Up = Kind == UpAndOut || Kind == UpAndIn;
+    // Vanilla is the American underlying; In is the contract not yet
+    // knocked in, which cannot be exercised and becomes Vanilla on a hit
+    vector<double> Vanilla(N + 1), In(N + 1), Stock(N + 1), ExVal(N + 1);
+    INSTR_COUNT(Allocations, 4);
+    Model.SLayer(N, Stock.data());
+    Underlying->PayoffBatch(Stock.data(), Vanilla.data(), N + 1);
+    for (int i = 0; i <= N; i++)
+        In[i] = (Up ? Stock[i] >= Level : Stock[i] <= Level) ? Vanilla[i] : Rebate;
+    for (int n = N - 1; n >= 0; n--)
+    {
+        Model.SLayer(n, Stock.data());
+        Underlying->PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+        for (int i = 0; i <= n; i++)
+        {
+            Vanilla[i] = max(ExVal[i], Disc * (q * Vanilla[i + 1] + (1 - q) * Vanilla[i]));
+            bool Hit = Up ? Stock[i] >= Level : Stock[i] <= Level;
+            In[i] = Hit ? Vanilla[i] : Disc * (q * In[i + 1] + (1 - q) * In[i]);
+        }
+        Nodes += n + 1;
+    }
+    return In[0];
+}
+
+void BarrierOption::PriceInOut(BinModel Model, double& OutPrice, double& InPrice)
+{
+    if (Model.HasDividends())
+    {
+        OutPrice = InPrice = NAN;
+        return;
+    }
+    double Inner, Outer, w;
+    Lines(Model, Inner, Outer, w);
+    Nodes = 0;
+    // In = Vanilla - (Out - Rebate Hit) + Rebate NoHit, and Hit + NoHit is
+    // the claim paying 1 at knock-out or at expiry
+    double HN = 0.0, HNInner = 0.0;
+    double* HNp = Rebate != 0.0 ? &HN : 0;
+    OutPrice = OutPass(Model, Outer, false, HNp);
+    if (w < 1.0)
+    {
+        double OutInner = OutPass(Model, Inner, false, Rebate != 0.0 ? &HNInner : 0);
+        OutPrice = OutInner + w * (OutPrice - OutInner);
+        HN = HNInner + w * (HN - HNInner);
+    }
+    InPrice = EurSum(*Underlying, Model) - OutPrice + Rebate * HN;
+}
+
+double BarrierOption::PriceByCRR(BinModel Model)
+{
+    double OutPrice, InPrice;
+    PriceInOut(Model, OutPrice, InPrice);
+    return Kind == UpAndOut || Kind == DownAndOut ? OutPrice : InPrice;
+}
+
+double BarrierOption::PriceBySnell(BinModel Model)
+{
+    if (Model.HasDividends())
+        return NAN;
+    double Inner, Outer, w;
+    Lines(Model, Inner, Outer, w);
+    Nodes = 0;
+    bool Out = Kind == UpAndOut || Kind == DownAndOut;
+    double Price = Out ? OutPass(Model, Outer, true, 0) : AmInPass(Model, Outer);
+    if (w < 1.0)
+    {
+        double PriceInner = Out ? OutPass(Model, Inner, true, 0) : AmInPass(Model, Inner);
+        Price = PriceInner + w * (Price - PriceInner);
+    }
+    return Price;
+}
+
+int BarrierOption::GetInputData()
+{
+    cout << "Enter barrier data:" << endl;
+    int Kind_;
+    cout << "Enter barrier type (0 up-and-out, 1 up-and-in, 2 down-and-out, 3 down-and-in): ";
+    cin >> Kind_;
+    cout << "Enter barrier H: ";
+    cin >> H;
+    cout << "Enter rebate: ";
+    cin >> Rebate;
+    cout << endl;
+    if (Kind_ < UpAndOut || Kind_ > DownAndIn || H <= 0.0 || Rebate < 0.0)
+    {
+        cout << "Illegal data ranges" << endl;
+        cout << "Terminating program" << endl;
+        return 1;
+    }
+    Kind = (BarrierKind)Kind_;
+    return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef BarrierOption_hpp
+#define BarrierOption_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+enum BarrierKind
+{
+    UpAndOut = 0,
+    UpAndIn,
+    DownAndOut,
+    DownAndIn
+};
+
+// Barrier contract on the expiry payoff of an underlying option, with the
+// barrier monitored at every step of the lattice. An out contract dies at
+// the first node at or beyond the barrier and pays the rebate there; an
+// in contract pays the underlying payoff only if such a node was reached,
+// and the rebate at expiry otherwise.
+//
+// Knocked-out nodes are not part of the induction: each layer only runs
+// over the nodes on the live side of the barrier. The barrier is aligned
+// to the lattice by pricing with the two node lines either side of it and
+// interpolating in log price, which removes most of the oscillation of
+// the price in N. The lines only stay put when (1+U)(1+D) = 1, as for CRR
+// parameters; on any other lattice H itself is monitored without
+// interpolation. European knock-ins come from in-out parity against the
+// O(N) European price of the underlying. The node lines are levels of a
+// geometric lattice, so a model with dividends prices as NaN.
+class BarrierOption
+{
+private:
+    Option* Underlying;
+    BarrierKind Kind;
+    double H;
+    double Rebate;
+    bool Aligned;
+    long long Nodes;
+    // knock-out induction with nodes at or beyond Level knocked out; also
+    // prices a claim paying 1 at knock-out or at expiry if HitOrExpiry
+    double OutPass(BinModel& Model, double Level, bool American, double* HitOrExpiry);
+    // American knock-in by induction against the American underlying
+    double AmInPass(BinModel& Model, double Level);
+    // node lines either side of H and the weight of the outer one
+    void Lines(BinModel& Model, double& Inner, double& Outer, double& w);
+public:
+    BarrierOption() : Underlying(0), Kind(UpAndOut), H(0.0), Rebate(0.0), Aligned(true), Nodes(0) { }
+    void SetUnderlying(Option* Underlying_) { Underlying = Underlying_; }
+    void SetBarrier(BarrierKind Kind_, double H_) { Kind = Kind_; H = H_; }
+    void SetRebate(double Rebate_) { Rebate = Rebate_; }
+    // false monitors H itself, without interpolating between node lines
+    void SetAligned(bool Aligned_) { Aligned = Aligned_; }
+    int GetInputData();
+    // pricing European barrier option
+    double PriceByCRR(BinModel Model);
+    // pricing American barrier option
+    double PriceBySnell(BinModel Model);
+    // European knock-out and knock-in prices of the same barrier and
+    // rebate from one knock-out induction
+    void PriceInOut(BinModel Model, double& OutPrice, double& InPrice);
+    // nodes evaluated by the last price
+    long long GetNodes() { return Nodes; }
+};
+#endif
@@ -14,6 +14,16 @@ double BearSpread::Payoff(double z)
         return 0.0;
 }
 
+void BearSpread::PayoffBatch(const double* z, double* Out, int n)
+{
+    double Cap = K2 - K1;
+    for (int i = 0; i < n; i++)
+    {
+        double v = z[i] < K2 ? K2 - z[i] : 0.0;
+        Out[i] = v < Cap ? v : Cap;
+    }
+}
+
 
 int BearSpread::GetInputData()
 {
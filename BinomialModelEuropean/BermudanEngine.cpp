@@ -0,0 +1,194 @@
+#include "BermudanEngine.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    // in-place radix-2 FFT, size a power of two; Inverse leaves out the
+    // division by the size
+    void FFT(vector<complex<double>>& a, bool Inverse)
+    {
+        int n = a.size();
+        for (int i = 1, j = 0; i < n; i++)
+        {
+            int Bit = n >> 1;
+            for (; j & Bit; Bit >>= 1)
+                j ^= Bit;
+            j ^= Bit;
+            if (i < j)
+                swap(a[i], a[j]);
+        }
+        // roots taken from cos and sin directly, not by recurrence
+        vector<complex<double>> Roots(n / 2);
+        for (int k = 0; k < n / 2; k++)
+        {
+            double Angle = 2.0 * M_PI * k / n * (Inverse ? 1 : -1);
+            Roots[k] = complex<double>(cos(Angle), sin(Angle));
+        }
+        for (int Len = 2; Len <= n; Len <<= 1)
+        {
+            int Stride = n / Len;
+            for (int i = 0; i < n; i += Len)
+                for (int k = 0; k < Len / 2; k++)
+                {
+                    complex<double> u = a[i + k];
+                    complex<double> v = a[i + k + Len / 2] * Roots[k * Stride];
+                    a[i + k] = u + v;
+                    a[i + k + Len / 2] = u - v;
+                }
+        }
+    }
+
+    // discounted k-step kernel w_j = C(k,j) q^j (1-q)^(k-j) (1+R)^-k and
+    // the share kernel ws_j = w_j (1+U)^j (1+D)^(k-j), weights Lo..Hi kept
+    void Kernel(int k, double q, BinModel& Model, int& Lo, int& Hi,
+                vector<double>& w, vector<double>& ws)
+    {
+        double a = log(1 + Model.GetU()), b = log(1 + Model.GetD());
+        vector<double> LogW(k + 1), LogWs(k + 1);
+        double Max = -INFINITY, MaxS = -INFINITY;
+        for (int j = 0; j <= k; j++)
+        {
+            LogW[j] = lgamma(k + 1.0) - lgamma(j + 1.0) - lgamma(k - j + 1.0)
+                      + j * log(q) + (k - j) * log(1 - q) - k * log(1 + Model.GetR());
+            LogWs[j] = LogW[j] + j * a + (k - j) * b;
+            Max = max(Max, LogW[j]);
+            MaxS = max(MaxS, LogWs[j]);
+        }
+        double Cut = log(1e-18);
+        Lo = 0;
+        while (LogW[Lo] < Max + Cut && LogWs[Lo] < MaxS + Cut)
+            Lo++;
+        Hi = k;
+        while (LogW[Hi] < Max + Cut && LogWs[Hi] < MaxS + Cut)
+            Hi--;
+        w.resize(Hi - Lo + 1);
+        ws.resize(Hi - Lo + 1);
+        for (int j = Lo; j <= Hi; j++)
+        {
+            w[j - Lo] = exp(LogW[j]);
+            ws[j - Lo] = exp(LogWs[j]);
+        }
+    }
+}
+
+void BermudanEngine::SetSchedule(const vector<int>& Schedule_)
+{
+    Schedule = Schedule_;
+    sort(Schedule.begin(), Schedule.end());
+    Schedule.erase(unique(Schedule.begin(), Schedule.end()), Schedule.end());
+}
+
+void BermudanEngine::SetEvenSchedule(int Dates, int N)
+{
+    vector<int> Steps;
+    for (int d = 1; d <= Dates; d++)
+        Steps.push_back((int)((long long)N * d / Dates));
+    SetSchedule(Steps);
+}
+
+double BermudanEngine::Price(Option& Opt, BinModel Model)
+{
+    int N = Opt.GetN();
+    double q = Model.RiskNeutProb();
+    Work = 0;
+    FFTJumps = 0;
+
+    // layers to stop at, from expiry back to the root
+    vector<int> Stops;
+    for (int t : Schedule)
+        if (t > 0 && t < N)
+            Stops.push_back(t);
+    Stops.push_back(0);
+    sort(Stops.rbegin(), Stops.rend());
+    bool ExerciseAtRoot = !Schedule.empty() && Schedule.front() == 0;
+
+    vector<double> Price(N + 1), Next(N + 1), Stock(N + 1), ExVal(N + 1), w, ws;
+    INSTR_COUNT(Allocations, 5);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        Opt.PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    INSTR_PHASE(InductionPhase);
+    int m = N;
+    for (int n : Stops)
+    {
+        int k = m - n, Lo, Hi;
+        Kernel(k, q, Model, Lo, Hi, w, ws);
+        int L = Hi - Lo + 1;
+        // direct cost against about 3 FFTs of the padded length
+        int Size = 1;
+        while (Size < m + 1 + L)
+            Size <<= 1;
+        double Direct = (double)(n + 1) * L;
+        double ByFFT = 3.0 * Size * log2((double)Size) * 4.0;
+        // the share kernel needs S(m,i+j)/S(n,i) to depend on j only,
+        // which escrowed dividends break
+        if (Direct <= ByFFT || Model.HasDividends())
+        {
+            for (int i = 0; i <= n; i++)
+            {
+                const double* v = Price.data() + i + Lo;
+                double Sum = 0.0;
+                for (int j = 0; j < L; j++)
+                    Sum += w[j] * v[j];
+                Next[i] = Sum;
+            }
+            Work += (long long)(n + 1) * L;
+        }
+        else
+        {
+            // Next[i] = sum_j w[j] Price[i+Lo+j] is entry i+Hi of the
+            // convolution of Price with the reversed kernel. Values grow
+            // like S far above S0, which would swamp the rounding of the
+            // transform, so that part is carried as Price/S against the
+            // share kernel and multiplied by S(n,i) afterwards. Both real
+            // convolutions share one transform of each side.
+            vector<complex<double>> a(Size), b(Size);
+            Model.SLayer(m, Stock.data());
+            for (int i = 0; i <= m; i++)
+                a[i] = Stock[i] <= Model.GetS0() ? complex<double>(Price[i], 0.0)
+                                                 : complex<double>(0.0, Price[i] / Stock[i]);
+            for (int t = 0; t < L; t++)
+                b[t] = complex<double>(w[L - 1 - t], ws[L - 1 - t]);
+            FFT(a, false);
+            FFT(b, false);
+            // the transforms of the real and imaginary parts are
+            // (Z[f] + conj(Z[-f]))/2 and (Z[f] - conj(Z[-f]))/2i
+            vector<complex<double>> c(Size);
+            const complex<double> I(0.0, 1.0);
+            for (int f = 0; f < Size; f++)
+            {
+                complex<double> Za = conj(a[(Size - f) & (Size - 1)]);
+                complex<double> Zb = conj(b[(Size - f) & (Size - 1)]);
+                complex<double> A1 = (a[f] + Za) * 0.5, A2 = (a[f] - Za) * (-0.5 * I);
+                complex<double> B1 = (b[f] + Zb) * 0.5, B2 = (b[f] - Zb) * (-0.5 * I);
+                c[f] = A1 * B1 + I * (A2 * B2);
+            }
+            FFT(c, true);
+            Model.SLayer(n, Stock.data());
+            for (int i = 0; i <= n; i++)
+                Next[i] = (c[i + Hi].real() + Stock[i] * c[i + Hi].imag()) / Size;
+            Work += (long long)(3.0 * Size * log2((double)Size));
+            FFTJumps++;
+        }
+        swap(Price, Next);
+        INSTR_COUNT(NodesVisited, n + 1);
+        if (n > 0 || ExerciseAtRoot)
+        {
+            Model.SLayer(n, Stock.data());
+            Opt.PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+            for (int i = 0; i <= n; i++)
+                Price[i] = max(Price[i], ExVal[i]);
+            INSTR_COUNT(PayoffEvals, n + 1);
+        }
+        m = n;
+    }
+    return Price[0];
+}
@@ -0,0 +1,32 @@
+#ifndef BermudanEngine_hpp
+#define BermudanEngine_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+// Bermudan pricing with exercise only on the steps of a schedule.
+//
+// Between two exercise dates k steps apart the value layer is carried
+// back in one jump, as the correlation of the layer with the k-step
+// binomial kernel C(k,j) q^j (1-q)^(k-j) (1+R)^-k. Kernel weights below
+// 1e-18 of the largest are dropped, which leaves about 17 sqrt(k q(1-q))
+// of them. A jump is done directly, or by FFT when the kernel is long;
+// the exercise step max(intrinsic, continuation) is only taken on dates.
+// With a dates the cost is about a N sqrt(N) or a N log N instead of N^2.
+class BermudanEngine
+{
+private:
+    std::vector<int> Schedule; // exercise steps, increasing
+    long long Work; // kernel multiply-adds of the last Price()
+    int FFTJumps; // jumps of the last Price() done by FFT
+public:
+    BermudanEngine() : Work(0), FFTJumps(0) { }
+    // exercise steps in 0..N; expiry is always an exercise date
+    void SetSchedule(const std::vector<int>& Schedule_);
+    // Dates exercise dates evenly spaced over N steps, the last at expiry
+    void SetEvenSchedule(int Dates, int N);
+    double Price(Option& Opt, BinModel Model);
+    long long GetWork() { return Work; }
+    int GetFFTJumps() { return FFTJumps; }
+};
+#endif
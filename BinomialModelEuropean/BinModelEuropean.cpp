@@ -6,9 +6,78 @@ double BinModel::RiskNeutProb()
 {
     return (R - D) / (U - D);
 }
+double BinModel::Escrowed(int n)
+{
+    if (Divs.empty())
+        return S0;
+    return (S0 - DivPV(0)) * DivFactor(n);
+}
 double BinModel::S(int n, int i)
 {
-    return S0 * pow(1 + U, i) * pow(1 + D, n - i);
+    double Geo = Escrowed(n) * pow(1 + U, i) * pow(1 + D, n - i);
+    return Divs.empty() ? Geo : Geo + DivPV(n);
+}
+void BinModel::SLayer(int n, double* Out)
+{
+    SRange(n, 0, n + 1, Out);
+}
+void BinModel::SRange(int n, int First, int Count, double* Out)
+{
+    // one pow per call; node First+k is S(n,First) times Ratio^k, taken in
+    // blocks of 8 so that the inner loop has no dependency between nodes
+    double Ratio = (1 + U) / (1 + D);
+    double RatioPow[8];
+    RatioPow[0] = 1.0;
+    for (int k = 1; k < 8; k++)
+        RatioPow[k] = RatioPow[k - 1] * Ratio;
+    double Ratio8 = RatioPow[7] * Ratio;
+    double Base = Escrowed(n) * pow(1 + U, First) * pow(1 + D, n - First);
+    for (int b = 0; b < Count; b += 8)
+    {
+        int Len = Count - b < 8 ? Count - b : 8;
+        for (int k = 0; k < Len; k++)
+            Out[b + k] = Base * RatioPow[k];
+        Base *= Ratio8;
+    }
+    if (Divs.empty())
+        return;
+    double PV = DivPV(n);
+    for (int k = 0; k < Count; k++)
+        Out[k] += PV;
+}
+int BinModel::AddDividend(int n, double Amount, bool Proportional)
+{
+    if (n < 1 || Amount < 0.0 || (Proportional && Amount >= 1.0))
+        return 1;
+    Divs.push_back({n, Amount, Proportional});
+    if (S0 - DivPV(0) <= 0.0)
+    {
+        Divs.pop_back();
+        return 1;
+    }
+    return 0;
+}
+double BinModel::DivPV(int n)
+{
+    double PV = 0.0;
+    for (const Dividend& d : Divs)
+        if (!d.Proportional && d.n > n)
+            PV += d.Amount * pow(1 + R, -(d.n - n));
+    return PV;
+}
+double BinModel::DivFactor(int n)
+{
+    double F = 1.0;
+    for (const Dividend& d : Divs)
+        if (d.Proportional && d.n <= n)
+            F *= 1 - d.Amount;
+    return F;
+}
+double BinModel::Forward(int n, double s, int N)
+{
+    if (Divs.empty())
+        return s * pow(1 + R, N - n);
+    return (s - DivPV(n)) * pow(1 + R, N - n) * DivFactor(N) / DivFactor(n) + DivPV(N);
 }
 int BinModel::GetInputData()
 {
@@ -44,4 +113,23 @@ int BinModel::GetInputData()
 double BinModel::GetR()
 {
     return R;
-}
\ No newline at end of file
+}
+int BinModel::SetData(double S0_, double U_, double D_, double R_)
+{
+    S0 = S0_;
+    U = U_;
+    D = D_;
+    R = R_;
+    // same range and arbitrage checks as GetInputData()
+    if (S0 <= 0.0 || U <= -1.0 || D <= -1.0 || U <= D || R <= -1.0)
+        return 1;
+    if (R >= U || R <= D)
+        return 1;
+    return 0;
+}
+int BinModel::SetCRRData(double S0_, double Sigma, double r, double T, int N)
+{
+    double dt = T / N;
+    return SetData(S0_, exp(Sigma * sqrt(dt)) - 1.0, exp(-Sigma * sqrt(dt)) - 1.0,
+                   exp(r * dt) - 1.0);
+}
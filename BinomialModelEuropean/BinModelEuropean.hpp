@@ -1,5 +1,14 @@
 #ifndef BinModelEuropean_hpp
 #define BinModelEuropean_hpp
+#include <vector>
+// dividend with the stock ex-dividend at layer n: a cash Amount, or a
+// proportional one of Amount times the price
+struct Dividend
+{
+    int n;
+    double Amount;
+    bool Proportional;
+};
 class BinModel
 {
 private:
@@ -7,14 +16,44 @@ private:
     double U;
     double D;
     double R;
+    std::vector<Dividend> Divs;
+    // the recombining part of S(n,i) at i=0 before the factors of U and D
+    double Escrowed(int n);
 
 public:
     // computing risk-neutral probability
     double RiskNeutProb();
     // computing the stock price at node n,i
     double S(int n, int i);
+    // computing the stock prices S(n,0),...,S(n,n) of layer n into Out
+    void SLayer(int n, double* Out);
+    // computing S(n,First),...,S(n,First+Count-1) into Out
+    void SRange(int n, int First, int Count, double* Out);
     // inputting, displaying and checking model data
     int GetInputData();
+    // setting and checking model data without console input
+    int SetData(double S0_, double U_, double D_, double R_);
+    // Cox-Ross-Rubinstein parameters for N steps over T years matching
+    // volatility Sigma and continuously compounded rate r
+    int SetCRRData(double S0_, double Sigma, double r, double T, int N);
+    // adding a dividend after SetData(); cash dividends are escrowed, so
+    // the lattice is built on S minus the present value of the cash
+    // dividends still to come and stays recombining; returns 1 if n < 1,
+    // a proportional Amount is outside [0,1) or the escrowed S0 is not
+    // positive
+    int AddDividend(int n, double Amount, bool Proportional);
+    void ClearDividends() { Divs.clear(); }
+    bool HasDividends() { return !Divs.empty(); }
+    const std::vector<Dividend>& GetDividends() { return Divs; }
+    // present value at step n of the cash dividends paid after step n
+    double DivPV(int n);
+    // product of 1-Amount over the proportional dividends up to step n
+    double DivFactor(int n);
+    // risk-neutral expectation of S(N) given S(n)=s
+    double Forward(int n, double s, int N);
     double GetR();
+    double GetS0() { return S0; }
+    double GetU() { return U; }
+    double GetD() { return D; }
 };
 #endif
\ No newline at end of file
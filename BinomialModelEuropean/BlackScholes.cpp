@@ -0,0 +1,71 @@
+#include "BlackScholes.hpp"
+#include <cmath>
+using namespace std;
+
+namespace
+{
+    double NormCdf(double x)
+    {
+        return 0.5 * erfc(-x / sqrt(2.0));
+    }
+}
+
+double BSCall(double S0, double K, double r, double Sigma, double T)
+{
+    double sd = Sigma * sqrt(T);
+    double d1 = (log(S0 / K) + (r + 0.5 * Sigma * Sigma) * T) / sd;
+    double d2 = d1 - sd;
+    return S0 * NormCdf(d1) - K * exp(-r * T) * NormCdf(d2);
+}
+
+double BSPut(double S0, double K, double r, double Sigma, double T)
+{
+    double sd = Sigma * sqrt(T);
+    double d1 = (log(S0 / K) + (r + 0.5 * Sigma * Sigma) * T) / sd;
+    double d2 = d1 - sd;
+    return K * exp(-r * T) * NormCdf(-d2) - S0 * NormCdf(-d1);
+}
+
+double BSDigitalCall(double S0, double K, double r, double Sigma, double T)
+{
+    double sd = Sigma * sqrt(T);
+    double d2 = (log(S0 / K) + (r - 0.5 * Sigma * Sigma) * T) / sd;
+    return exp(-r * T) * NormCdf(d2);
+}
+
+int BSPrice(PayoffKind Kind, double K1, double K2, double S0, double r,
+            double Sigma, double T, double& Price)
+{
+    switch (Kind)
+    {
+    case CallPayoff:
+        Price = BSCall(S0, K1, r, Sigma, T);
+        return 0;
+    case PutPayoff:
+        Price = BSPut(S0, K1, r, Sigma, T);
+        return 0;
+    case DoubDigitPayoff:
+        Price = BSDigitalCall(S0, K1, r, Sigma, T) - BSDigitalCall(S0, K2, r, Sigma, T);
+        return 0;
+    case StranglePayoff:
+        Price = BSPut(S0, K1, r, Sigma, T) + BSCall(S0, K2, r, Sigma, T);
+        return 0;
+    case ButterflyPayoff:
+    {
+        // (z-K1)/2 on (K1,M] and K2-z on (M,K2], M the midpoint, equals
+        // calls at K1, M, K2 plus a digital of (K2-K1)/4 at M for the jump
+        double M = (K1 + K2) / 2.0;
+        Price = 0.5 * BSCall(S0, K1, r, Sigma, T) - 1.5 * BSCall(S0, M, r, Sigma, T) +
+                BSCall(S0, K2, r, Sigma, T) + 0.25 * (K2 - K1) * BSDigitalCall(S0, M, r, Sigma, T);
+        return 0;
+    }
+    case BullSpreadPayoff:
+        Price = BSCall(S0, K1, r, Sigma, T) - BSCall(S0, K2, r, Sigma, T);
+        return 0;
+    case BearSpreadPayoff:
+        Price = BSPut(S0, K2, r, Sigma, T) - BSPut(S0, K1, r, Sigma, T);
+        return 0;
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef BlackScholes_hpp
+#define BlackScholes_hpp
+#include "OptionsEuropean.hpp"
+// Black-Scholes prices, r continuously compounded, T in years
+double BSCall(double S0, double K, double r, double Sigma, double T);
+double BSPut(double S0, double K, double r, double Sigma, double T);
+// cash-or-nothing call paying 1 if S_T > K
+double BSDigitalCall(double S0, double K, double r, double Sigma, double T);
+// continuous-time limit of a library payoff, built from calls, puts and
+// digitals by linearity; returns 1 for UserPayoff
+int BSPrice(PayoffKind Kind, double K1, double K2, double S0, double r,
+            double Sigma, double T, double& Price);
+#endif
@@ -14,6 +14,16 @@ double BullSpread::Payoff(double z)
         return K2 - K1;
 }
 
+void BullSpread::PayoffBatch(const double* z, double* Out, int n)
+{
+    double Cap = K2 - K1;
+    for (int i = 0; i < n; i++)
+    {
+        double v = z[i] > K1 ? z[i] - K1 : 0.0;
+        Out[i] = v < Cap ? v : Cap;
+    }
+}
+
 
 int BullSpread::GetInputData()
 {
@@ -3,7 +3,7 @@
 
 #include "OptionsEuropean.hpp" 
 
-class BullSpread : public EurOption
+class BullSpread : public EurOption, public AmOption
 {
 private:
     double K1; // lower strike price
@@ -14,10 +14,16 @@ public:
 
     // override the Payoff function
     double Payoff(double z) override;
+    void PayoffBatch(const double* z, double* Out, int n) override;
 
     // accessor methods
+    void SetK1(double K1_) { K1 = K1_; }
+    void SetK2(double K2_) { K2 = K2_; }
     double GetK1() const { return K1; }
     double GetK2() const { return K2; }
+    PayoffKind GetKind() { return BullSpreadPayoff; }
+    void GetStrikes(double& K1_, double& K2_) { K1_ = K1; K2_ = K2; }
+    void SetStrikes(double K1_, double K2_) { K1 = K1_; K2 = K2_; }
 
     // method to get input data
     int GetInputData();
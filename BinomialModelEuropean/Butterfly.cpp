@@ -17,6 +17,18 @@ double Butterfly::Payoff(double z)
         return 0.0;
 }
 
+void Butterfly::PayoffBatch(const double* z, double* Out, int n)
+{
+    double midpoint = (K1 + K2) / 2.0;
+    for (int i = 0; i < n; i++)
+    {
+        double Rising = (z[i] - K1) / 2.0;
+        double Falling = K2 - z[i];
+        double v = (z[i] > K1) & (z[i] <= midpoint) ? Rising : 0.0;
+        Out[i] = (z[i] > midpoint) & (z[i] <= K2) ? Falling : v;
+    }
+}
+
 
 int Butterfly::GetInputData()
 {
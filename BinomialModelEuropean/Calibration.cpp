@@ -0,0 +1,246 @@
+#include "Calibration.hpp"
+#include "BinModelEuropean.hpp"
+#include "PayoffFactory.hpp"
+#include "ThreadTeam.hpp"
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+using namespace std;
+
+double SumPrice(Option& Opt, const PayoffShape& Shape, double S0, double U, double D,
+                double R, int N, double& dU, double& dD)
+{
+    thread_local vector<double> Stock, Pay;
+    Stock.resize(N + 1);
+    Pay.resize(N + 1);
+    BinModel Model;
+    Model.SetData(S0, U, D, R);
+    Model.SLayer(N, Stock.data());
+    Opt.PayoffBatch(Stock.data(), Pay.data(), N + 1);
+
+    double q = (R - D) / (U - D);
+    double dqdU = -q / (U - D), dqdD = (q - 1) / (U - D);
+    double LogW = N * log(1 - q) - N * log(1 + R);
+    double Price = 0.0;
+    dU = 0.0;
+    dD = 0.0;
+    for (int i = 0; i <= N; i++)
+    {
+        double w = exp(LogW);
+        // d log w / dq, and the payoff slope times dS/dU and dS/dD
+        double dLogW = i / q - (N - i) / (1 - q);
+        double Slope = Shape.B[PieceOf(Shape, Stock[i])] * Stock[i];
+        Price += w * Pay[i];
+        dU += w * (Pay[i] * dLogW * dqdU + Slope * i / (1 + U));
+        dD += w * (Pay[i] * dLogW * dqdD + Slope * (N - i) / (1 + D));
+        if (i < N)
+            LogW += log(q) - log(1 - q) + log((double)(N - i) / (i + 1));
+    }
+    return Price;
+}
+
+Calibrator::~Calibrator()
+{
+    for (Option* p : Payoffs)
+        delete p;
+}
+
+int Calibrator::AddQuote(const MarketQuote& Q)
+{
+    Option* Opt = MakePayoff(Q.Kind, Q.K1, Q.K2, N);
+    if (!Opt)
+        return 1;
+    PayoffShape Shape;
+    GetPayoffShape(*Opt, Shape);
+    // the Jacobian has no term for a jump crossing a node, so payoffs
+    // that jump (digitals) would get a wrong gradient
+    for (size_t j = 0; j < Shape.Breaks.size(); j++)
+    {
+        double z = Shape.Breaks[j];
+        double Left = Shape.A[j] + Shape.B[j] * z, Right = Shape.A[j + 1] + Shape.B[j + 1] * z;
+        if (fabs(Left - Right) > 1e-12 * (1 + fabs(Left)))
+        {
+            delete Opt;
+            return 1;
+        }
+    }
+    Quotes.push_back(Q);
+    Payoffs.push_back(Opt);
+    Shapes.push_back(Shape);
+    return 0;
+}
+
+void Calibrator::Residuals(double U, double D, vector<double>& Res, vector<double>& dU,
+                           vector<double>& dD)
+{
+    int K = Quotes.size();
+    Res.resize(K);
+    dU.resize(K);
+    dD.resize(K);
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, K));
+    Team.Run([&](int t)
+    {
+        int First, Last;
+        Team.Split(t, 0, K - 1, First, Last);
+        for (int k = First; k <= Last; k++)
+        {
+            Payoffs[k]->SetN(N);
+            double Price = SumPrice(*Payoffs[k], Shapes[k], S0, U, D, R, N, dU[k], dD[k]);
+            Res[k] = Quotes[k].Weight * (Price - Quotes[k].Price);
+            dU[k] *= Quotes[k].Weight;
+            dD[k] *= Quotes[k].Weight;
+        }
+    });
+}
+
+int Calibrator::Calibrate(double& U, double& D)
+{
+    if (D <= -1.0 || D >= R || U <= R || Quotes.empty())
+        return 1;
+    vector<double> Res, dU, dD;
+    Residuals(U, D, Res, dU, dD);
+    double SS = 0.0;
+    for (double r : Res)
+        SS += r * r;
+    double Lambda = 1e-3;
+    Iterations = 0;
+    while (Iterations < MaxIter)
+    {
+        Iterations++;
+        // normal equations J'J d = -J'r with the diagonal scaled by 1+Lambda
+        double A = 0.0, B = 0.0, C = 0.0, gU = 0.0, gD = 0.0;
+        for (size_t k = 0; k < Res.size(); k++)
+        {
+            A += dU[k] * dU[k];
+            B += dU[k] * dD[k];
+            C += dD[k] * dD[k];
+            gU += dU[k] * Res[k];
+            gD += dD[k] * Res[k];
+        }
+        bool Improved = false;
+        double NewSS = SS, NewU = U, NewD = D;
+        vector<double> NewRes, NewdU, NewdD;
+        while (Lambda < 1e12)
+        {
+            double a = A * (1 + Lambda), c = C * (1 + Lambda);
+            double Det = a * c - B * B;
+            double StepU = Det != 0.0 ? -(c * gU - B * gD) / Det : 0.0;
+            double StepD = Det != 0.0 ? -(a * gD - B * gU) / Det : 0.0;
+            NewU = U + StepU;
+            NewD = D + StepD;
+            if (NewD > -1.0 && NewD < R && NewU > R)
+            {
+                Residuals(NewU, NewD, NewRes, NewdU, NewdD);
+                NewSS = 0.0;
+                for (double r : NewRes)
+                    NewSS += r * r;
+                if (NewSS < SS)
+                {
+                    Improved = true;
+                    break;
+                }
+            }
+            Lambda *= 10.0;
+        }
+        if (!Improved)
+            break;
+        double Gain = (SS - NewSS) / SS;
+        U = NewU;
+        D = NewD;
+        SS = NewSS;
+        Res.swap(NewRes);
+        dU.swap(NewdU);
+        dD.swap(NewdD);
+        Lambda = max(Lambda / 10.0, 1e-12);
+        if (Gain < Tol || SS == 0.0)
+            break;
+    }
+    RMS = sqrt(SS / Res.size());
+    return 0;
+}
+
+int Calibrator::LoadFit(const string& Path, double& U, double& D)
+{
+    ifstream in(Path);
+    double U_, D_;
+    if (!(in >> U_ >> D_))
+        return 1;
+    U = U_;
+    D = D_;
+    return 0;
+}
+
+int Calibrator::SaveFit(const string& Path, double U, double D)
+{
+    ofstream out(Path);
+    out << setprecision(17) << U << " " << D << " " << RMS << endl;
+    return out.good() ? 0 : 1;
+}
+
+void ImpliedU(const vector<MarketQuote>& Quotes, double S0, double R, int N, vector<double>& U,
+              int Threads)
+{
+    int K = Quotes.size();
+    vector<Option*> Payoffs(K);
+    vector<PayoffShape> Shapes(K);
+    for (int k = 0; k < K; k++)
+    {
+        Payoffs[k] = MakePayoff(Quotes[k].Kind, Quotes[k].K1, Quotes[k].K2, N);
+        if (Payoffs[k])
+            GetPayoffShape(*Payoffs[k], Shapes[k]);
+    }
+    // price of quote k in the model with up move u
+    auto Price = [&](int k, double u)
+    {
+        double dU, dD;
+        return SumPrice(*Payoffs[k], Shapes[k], S0, u, 1.0 / (1 + u) - 1, R, N, dU, dD);
+    };
+    vector<double> Lo(K), Hi(K), FLo(K), FHi(K);
+    U.assign(K, NAN);
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, max(K, 1)));
+    Team.Run([&](int t)
+    {
+        int First, Last;
+        Team.Split(t, 0, K - 1, First, Last);
+        for (int k = First; k <= Last; k++)
+        {
+            Lo[k] = max(R, 0.0) + 1e-9;
+            Hi[k] = 1.0;
+            // no payoff of that kind: both ends alike, so U[k] stays NaN
+            if (!Payoffs[k])
+            {
+                FLo[k] = FHi[k] = 1.0;
+                continue;
+            }
+            FLo[k] = Price(k, Lo[k]) - Quotes[k].Price;
+            FHi[k] = Price(k, Hi[k]) - Quotes[k].Price;
+        }
+        // every quote takes the same 60 halvings, so the threads stay
+        // balanced without coordination
+        for (int Iter = 0; Iter < 60; Iter++)
+            for (int k = First; k <= Last; k++)
+            {
+                if (FLo[k] * FHi[k] > 0.0)
+                    continue;
+                double Mid = 0.5 * (Lo[k] + Hi[k]);
+                double FMid = Price(k, Mid) - Quotes[k].Price;
+                if ((FMid < 0.0) == (FLo[k] < 0.0))
+                {
+                    Lo[k] = Mid;
+                    FLo[k] = FMid;
+                }
+                else
+                {
+                    Hi[k] = Mid;
+                    FHi[k] = FMid;
+                }
+            }
+        for (int k = First; k <= Last; k++)
+            if (FLo[k] * FHi[k] <= 0.0)
+                U[k] = 0.5 * (Lo[k] + Hi[k]);
+    });
+    for (Option* p : Payoffs)
+        delete p;
+}
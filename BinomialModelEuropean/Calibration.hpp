@@ -0,0 +1,80 @@
+#ifndef Calibration_hpp
+#define Calibration_hpp
+#include "OptionsEuropean.hpp"
+#include "PayoffShape.hpp"
+#include <string>
+#include <vector>
+
+// market price of a European contract expiring after N steps
+struct MarketQuote
+{
+    PayoffKind Kind;
+    double K1;
+    double K2; // 0.0 for calls and puts
+    double Price;
+    double Weight;
+};
+
+// Fitting U and D of a BinModel with given S0 and R to market quotes.
+//
+// Every quote is priced by the O(N) expectation over the leaves, and its
+// derivatives in U and D come analytically from the same sum (through
+// the risk-neutral weights and the slope of each payoff piece), so one
+// objective evaluation with its Jacobian costs O(N) per quote. Quotes are
+// split between threads. Levenberg-Marquardt steps that leave the
+// arbitrage-free range -1 < D < R < U are rejected like steps that do not
+// reduce the error.
+class Calibrator
+{
+private:
+    double S0;
+    double R;
+    int N;
+    int Threads;
+    int MaxIter;
+    double Tol;
+    std::vector<MarketQuote> Quotes;
+    std::vector<Option*> Payoffs;
+    std::vector<PayoffShape> Shapes;
+    double RMS;
+    int Iterations;
+    // weighted residuals and their derivatives in U and D
+    void Residuals(double U, double D, std::vector<double>& Res, std::vector<double>& dU,
+                   std::vector<double>& dD);
+public:
+    Calibrator() : S0(100.0), R(0.0), N(100), Threads(1), MaxIter(100), Tol(1e-12), RMS(0.0), Iterations(0) { }
+    ~Calibrator();
+    Calibrator(const Calibrator&) = delete;
+    Calibrator& operator=(const Calibrator&) = delete;
+    void SetModel(double S0_, double R_, int N_) { S0 = S0_; R = R_; N = N_; }
+    void SetThreads(int Threads_) { Threads = Threads_; }
+    void SetMaxIterations(int MaxIter_) { MaxIter = MaxIter_; }
+    // stopping once a step improves the sum of squares by less than Tol
+    // relative to it
+    void SetTolerance(double Tol_) { Tol = Tol_; }
+    // returns 1 for a kind with no library payoff, or for a payoff that
+    // jumps, as the analytic Jacobian has no term for a jump
+    int AddQuote(const MarketQuote& Q);
+    // fitting from the starting point in U and D, returns 1 if the start
+    // is not arbitrage-free
+    int Calibrate(double& U, double& D);
+    // root mean square of the weighted pricing errors of the last fit
+    double GetRMS() { return RMS; }
+    int GetIterations() { return Iterations; }
+    // reading a previous fit as the starting point, returns 1 if there
+    // is none; writing the last fit
+    int LoadFit(const std::string& Path, double& U, double& D);
+    int SaveFit(const std::string& Path, double U, double D);
+};
+
+// price of a European contract on (S0, U, D, R) with N steps by the O(N)
+// expectation over the leaves, and its derivatives in U and D
+double SumPrice(Option& Opt, const PayoffShape& Shape, double S0, double U, double D,
+                double R, int N, double& dU, double& dD);
+
+// U of the CRR-style model (1+U)(1+D) = 1 reproducing each quote on its
+// own, all quotes bisected together; NaN where no U in (R, 1] fits or
+// the kind has no library payoff
+void ImpliedU(const std::vector<MarketQuote>& Quotes, double S0, double R, int N,
+              std::vector<double>& U, int Threads = 1);
+#endif
@@ -0,0 +1,312 @@
+#include "ChebyshevProxy.hpp"
+#include "BinModelEuropean.hpp"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace
+{
+    // Chebyshev coefficients along dimension Dim of a tensor of values at
+    // Lobatto nodes cos(pi j / n), coefficients in the same layout
+    void Transform(vector<double>& F, const int* Size, int Dim)
+    {
+        int n = Size[Dim] - 1;
+        int Inner = 1;
+        for (int d = Dim + 1; d < 3; d++)
+            Inner *= Size[d];
+        int Outer = 1;
+        for (int d = 0; d < Dim; d++)
+            Outer *= Size[d];
+        vector<double> Line(n + 1), Out(n + 1);
+        for (int o = 0; o < Outer; o++)
+            for (int in = 0; in < Inner; in++)
+            {
+                double* Base = F.data() + (size_t)o * Size[Dim] * Inner + in;
+                for (int j = 0; j <= n; j++)
+                    Line[j] = Base[(size_t)j * Inner];
+                for (int k = 0; k <= n; k++)
+                {
+                    double Sum = 0.5 * (Line[0] + Line[n] * (k % 2 ? -1.0 : 1.0));
+                    for (int j = 1; j < n; j++)
+                        Sum += Line[j] * cos(M_PI * j * k / n);
+                    Out[k] = 2.0 * Sum / n;
+                }
+                Out[0] *= 0.5;
+                Out[n] *= 0.5;
+                for (int k = 0; k <= n; k++)
+                    Base[(size_t)k * Inner] = Out[k];
+            }
+    }
+
+    // coefficients of the derivative along Dim, for a dimension mapped
+    // from an interval of length Width
+    void Differentiate(const vector<double>& C, vector<double>& D, const int* Size, int Dim,
+                       double Width)
+    {
+        int n = Size[Dim] - 1;
+        int Inner = 1;
+        for (int d = Dim + 1; d < 3; d++)
+            Inner *= Size[d];
+        int Outer = 1;
+        for (int d = 0; d < Dim; d++)
+            Outer *= Size[d];
+        D.assign(C.size(), 0.0);
+        vector<double> Out(n + 2);
+        for (int o = 0; o < Outer; o++)
+            for (int in = 0; in < Inner; in++)
+            {
+                size_t Base = (size_t)o * Size[Dim] * Inner + in;
+                // d[k-1] = d[k+1] + 2k c[k], then d[0] halved
+                fill(Out.begin(), Out.end(), 0.0);
+                for (int k = n; k >= 1; k--)
+                    Out[k - 1] = Out[k + 1] + 2.0 * k * C[Base + (size_t)k * Inner];
+                Out[0] *= 0.5;
+                for (int k = 0; k <= n; k++)
+                    D[Base + (size_t)k * Inner] = Out[k] * 2.0 / Width;
+            }
+    }
+}
+
+ChebyshevProxy::ChebyshevProxy()
+    : T(1.0), MaxDeg(32), Tol(1e-3), Smoothing(8), ErrorEstimate(0.0), Kind(UserPayoff), N(0), K1(0.0),
+      K2(0.0), American(false)
+{
+    SetBox(80.0, 120.0, 0.1, 0.4, 0.0, 0.1);
+    Deg[0] = Deg[1] = Deg[2] = 4;
+}
+
+void ChebyshevProxy::SetBox(double S0Lo, double S0Hi, double SigmaLo, double SigmaHi,
+                            double rLo, double rHi)
+{
+    Lo[0] = S0Lo;
+    Hi[0] = S0Hi;
+    Lo[1] = SigmaLo;
+    Hi[1] = SigmaHi;
+    Lo[2] = rLo;
+    Hi[2] = rHi;
+}
+
+int ChebyshevProxy::Sample(Option& Opt, int i0, int i1, int i2, double& Price)
+{
+    long long Key = ((long long)i0 * (MaxDeg + 1) + i1) * (MaxDeg + 1) + i2;
+    auto It = Samples.find(Key);
+    if (It != Samples.end())
+    {
+        Price = It->second;
+        return 0;
+    }
+    int Index[3] = {i0, i1, i2};
+    double x[3];
+    for (int d = 0; d < 3; d++)
+        x[d] = 0.5 * (Lo[d] + Hi[d]) + 0.5 * (Hi[d] - Lo[d]) * cos(M_PI * Index[d] / MaxDeg);
+    // the lattice price moves with the position of the strikes between
+    // nodes, periodically in log S0 with period 2 Sigma sqrt(dt); the mean
+    // over Smoothing points across one period removes that sawtooth
+    double Period = 2.0 * x[1] * sqrt(T / N);
+    Price = 0.0;
+    for (int m = 0; m < Smoothing; m++)
+    {
+        double Shift = Smoothing > 1 ? ((m + 0.5) / Smoothing - 0.5) * Period : 0.0;
+        BinModel Model;
+        if (Model.SetCRRData(x[0] * exp(Shift), x[1], x[2], T, N) == 1)
+            return 1;
+        if (American)
+            Price += dynamic_cast<AmOption&>(Opt).PriceBySnell(Model);
+        else
+            Price += dynamic_cast<EurOption&>(Opt).PriceByCRR(Model);
+    }
+    Price /= Smoothing;
+    Samples[Key] = Price;
+    return 0;
+}
+
+int ChebyshevProxy::Fit(Option& Opt, double* Tail)
+{
+    int Size[3] = {Deg[0] + 1, Deg[1] + 1, Deg[2] + 1};
+    Coef.assign((size_t)Size[0] * Size[1] * Size[2], 0.0);
+    for (int a = 0; a < Size[0]; a++)
+        for (int b = 0; b < Size[1]; b++)
+            for (int c = 0; c < Size[2]; c++)
+                if (Sample(Opt, a * (MaxDeg / Deg[0]), b * (MaxDeg / Deg[1]),
+                           c * (MaxDeg / Deg[2]), Coef[((size_t)a * Size[1] + b) * Size[2] + c]) == 1)
+                    return 1;
+    for (int d = 0; d < 3; d++)
+        Transform(Coef, Size, d);
+
+    // what the two top degrees of each dimension still contribute
+    for (int d = 0; d < 3; d++)
+        Tail[d] = 0.0;
+    for (int a = 0; a < Size[0]; a++)
+        for (int b = 0; b < Size[1]; b++)
+            for (int c = 0; c < Size[2]; c++)
+            {
+                double v = fabs(Coef[((size_t)a * Size[1] + b) * Size[2] + c]);
+                if (a >= Deg[0] - 1)
+                    Tail[0] += v;
+                if (b >= Deg[1] - 1)
+                    Tail[1] += v;
+                if (c >= Deg[2] - 1)
+                    Tail[2] += v;
+            }
+
+    Differentiate(Coef, CoefS, Size, 0, Hi[0] - Lo[0]);
+    Differentiate(CoefS, CoefSS, Size, 0, Hi[0] - Lo[0]);
+    Differentiate(Coef, CoefV, Size, 1, Hi[1] - Lo[1]);
+    Differentiate(Coef, CoefR, Size, 2, Hi[2] - Lo[2]);
+    return 0;
+}
+
+int ChebyshevProxy::Build(Option& Opt, bool American_)
+{
+    American = American_;
+    N = Opt.GetN();
+    Kind = Opt.GetKind();
+    Opt.GetStrikes(K1, K2);
+    int Pow2 = 1;
+    while (Pow2 * 2 <= min(MaxDeg, 64))
+        Pow2 *= 2;
+    MaxDeg = Pow2;
+    Samples.clear();
+    Deg[0] = Deg[1] = Deg[2] = min(4, MaxDeg);
+    while (true)
+    {
+        double Tail[3];
+        if (Fit(Opt, Tail) == 1)
+            return 1;
+        ErrorEstimate = Tail[0] + Tail[1] + Tail[2];
+        bool Refined = false;
+        for (int d = 0; d < 3; d++)
+            if (Tail[d] > Tol && Deg[d] < MaxDeg)
+            {
+                Deg[d] *= 2;
+                Refined = true;
+            }
+        if (!Refined)
+            break;
+    }
+    Samples.clear();
+    return 0;
+}
+
+double ChebyshevProxy::Eval(const vector<double>& C, double S0, double Sigma, double r)
+{
+    double Point[3] = {S0, Sigma, r};
+    double Tk[3][65];
+    for (int d = 0; d < 3; d++)
+    {
+        double x = (2.0 * Point[d] - Lo[d] - Hi[d]) / (Hi[d] - Lo[d]);
+        Tk[d][0] = 1.0;
+        Tk[d][1] = x;
+        for (int k = 2; k <= Deg[d]; k++)
+            Tk[d][k] = 2.0 * x * Tk[d][k - 1] - Tk[d][k - 2];
+    }
+    const double* p = C.data();
+    double Sum = 0.0;
+    for (int a = 0; a <= Deg[0]; a++)
+    {
+        double SumA = 0.0;
+        for (int b = 0; b <= Deg[1]; b++)
+        {
+            double SumB = 0.0;
+            for (int c = 0; c <= Deg[2]; c++)
+                SumB += p[c] * Tk[2][c];
+            p += Deg[2] + 1;
+            SumA += SumB * Tk[1][b];
+        }
+        Sum += SumA * Tk[0][a];
+    }
+    return Sum;
+}
+
+double ChebyshevProxy::Price(double S0, double Sigma, double r)
+{
+    return Eval(Coef, S0, Sigma, r);
+}
+
+void ChebyshevProxy::Greeks(double S0, double Sigma, double r, double& Price, double& Delta,
+                            double& Gamma, double& Vega, double& Rho)
+{
+    Price = Eval(Coef, S0, Sigma, r);
+    Delta = Eval(CoefS, S0, Sigma, r);
+    Gamma = Eval(CoefSS, S0, Sigma, r);
+    Vega = Eval(CoefV, S0, Sigma, r);
+    Rho = Eval(CoefR, S0, Sigma, r);
+}
+
+int ChebyshevProxy::Save(const string& Path)
+{
+    ofstream out(Path);
+    if (!out)
+        return 1;
+    out << setprecision(17);
+    out << "ChebyshevProxy 1" << endl;
+    out << Kind << " " << N << " " << K1 << " " << K2 << " " << (American ? 1 : 0) << endl;
+    out << T << endl;
+    for (int d = 0; d < 3; d++)
+        out << Lo[d] << " " << Hi[d] << endl;
+    out << Deg[0] << " " << Deg[1] << " " << Deg[2] << " " << ErrorEstimate << endl;
+    const vector<double>* All[] = {&Coef, &CoefS, &CoefSS, &CoefV, &CoefR};
+    for (const vector<double>* C : All)
+    {
+        for (double v : *C)
+            out << v << "\n";
+    }
+    return out.good() ? 0 : 1;
+}
+
+int ChebyshevProxy::Load(const string& Path, Option& Opt, bool American_)
+{
+    ifstream in(Path);
+    string Magic;
+    int Version, Kind_, N_, Am;
+    double K1_, K2_;
+    if (!(in >> Magic >> Version) || Magic != "ChebyshevProxy" || Version != 1)
+        return 1;
+    if (!(in >> Kind_ >> N_ >> K1_ >> K2_ >> Am))
+        return 1;
+    double OptK1, OptK2;
+    Opt.GetStrikes(OptK1, OptK2);
+    if (Kind_ != Opt.GetKind() || N_ != Opt.GetN() || K1_ != OptK1 || K2_ != OptK2 ||
+        (Am == 1) != American_)
+        return 1;
+    // everything is read into locals, the proxy only changes once the
+    // whole file has been read
+    int Deg_[3];
+    double T_, Lo_[3], Hi_[3], Error_;
+    in >> T_;
+    for (int d = 0; d < 3; d++)
+        in >> Lo_[d] >> Hi_[d];
+    in >> Deg_[0] >> Deg_[1] >> Deg_[2] >> Error_;
+    if (!in || Deg_[0] < 1 || Deg_[1] < 1 || Deg_[2] < 1 || Deg_[0] > 64 || Deg_[1] > 64 ||
+        Deg_[2] > 64)
+        return 1;
+    size_t Count = (size_t)(Deg_[0] + 1) * (Deg_[1] + 1) * (Deg_[2] + 1);
+    vector<double> Read[5];
+    for (vector<double>& C : Read)
+    {
+        C.resize(Count);
+        for (double& v : C)
+            in >> v;
+    }
+    if (!in)
+        return 1;
+    vector<double>* All[] = {&Coef, &CoefS, &CoefSS, &CoefV, &CoefR};
+    for (int c = 0; c < 5; c++)
+        All[c]->swap(Read[c]);
+    T = T_;
+    for (int d = 0; d < 3; d++)
+    {
+        Lo[d] = Lo_[d];
+        Hi[d] = Hi_[d];
+        Deg[d] = Deg_[d];
+    }
+    ErrorEstimate = Error_;
+    Kind = Kind_;
+    N = N_;
+    K1 = K1_;
+    K2 = K2_;
+    American = American_;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef ChebyshevProxy_hpp
+#define ChebyshevProxy_hpp
+#include "OptionsEuropean.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+// Price of one contract as a function of (S0, Sigma, r) over a box,
+// interpolated on a tensor grid of Chebyshev-Lobatto nodes from lattice
+// prices on CRR models (SetCRRData with the contract's N and maturity T).
+//
+// Build() starts at degree 4 in every dimension and doubles a dimension
+// while the coefficients of its top two degrees add up to more than the
+// tolerance; the nodes are nested, so no lattice price is computed twice.
+// The CRR price oscillates with the position of the strikes between
+// nodes, so each sample is the mean lattice price over a few spot shifts
+// spanning one node spacing (SetSmoothing). American prices keep more of
+// that oscillation and usually refine up to the maximum degree. Price
+// and Greeks cost (Deg0+1)(Deg1+1)(Deg2+1) multiply-adds.
+class ChebyshevProxy
+{
+private:
+    double Lo[3], Hi[3]; // S0, Sigma, r
+    double T;
+    int MaxDeg;
+    double Tol;
+    int Smoothing;
+    int Deg[3];
+    double ErrorEstimate;
+    // coefficients of the price and of its derivatives d/dS0, d2/dS0^2,
+    // d/dSigma and d/dr, index (a*(Deg[1]+1) + b)*(Deg[2]+1) + c
+    std::vector<double> Coef, CoefS, CoefSS, CoefV, CoefR;
+    // identification of the contract stored with the proxy
+    int Kind, N;
+    double K1, K2;
+    bool American;
+    std::map<long long, double> Samples; // lattice prices by node at MaxDeg
+    // lattice price at node (i0, i1, i2) of the MaxDeg grid, returns 1
+    // if the model there is illegal
+    int Sample(Option& Opt, int i0, int i1, int i2, double& Price);
+    // coefficients at the current degrees, Tail[d] the weight of the two
+    // top degrees of dimension d
+    int Fit(Option& Opt, double* Tail);
+    double Eval(const std::vector<double>& C, double S0, double Sigma, double r);
+public:
+    ChebyshevProxy();
+    void SetBox(double S0Lo, double S0Hi, double SigmaLo, double SigmaHi, double rLo,
+                double rHi);
+    void SetMaturity(double T_) { T = T_; }
+    // absolute price tolerance of the refinement
+    void SetTolerance(double Tol_) { Tol = Tol_; }
+    // lattice prices averaged per sample, 1 for the raw lattice price
+    void SetSmoothing(int Smoothing_) { Smoothing = Smoothing_ < 1 ? 1 : Smoothing_; }
+    // largest degree per dimension, a power of two up to 64
+    void SetMaxDegree(int MaxDeg_) { MaxDeg = MaxDeg_; }
+    // sampling the lattice and fitting, returns 1 if a sample model is
+    // illegal (box outside the arbitrage-free range)
+    int Build(Option& Opt, bool American_);
+    double Price(double S0, double Sigma, double r);
+    void Greeks(double S0, double Sigma, double r, double& Price, double& Delta,
+                double& Gamma, double& Vega, double& Rho);
+    double GetErrorEstimate() { return ErrorEstimate; }
+    int GetDegree(int Dim) { return Deg[Dim]; }
+    // writing the proxy to a text file, returns 1 on failure
+    int Save(const std::string& Path);
+    // reading a proxy for Opt, returns 1 on failure or if the file was
+    // built for another contract
+    int Load(const std::string& Path, Option& Opt, bool American_);
+};
+#endif
@@ -0,0 +1,130 @@
+#include "CheckpointedLattice.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+void CheckpointedLattice::Step(int n, const double* Next, double* Out, vector<double>& Stock,
+                               vector<double>& ExVal)
+{
+    double q = Model.RiskNeutProb();
+    double Disc = 1.0 / (1 + Model.GetR());
+    for (int i = 0; i <= n; i++)
+        Out[i] = Disc * (q * Next[i + 1] + (1 - q) * Next[i]);
+    if (American)
+    {
+        Model.SLayer(n, Stock.data());
+        Opt->PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+        for (int i = 0; i <= n; i++)
+            Out[i] = max(Out[i], ExVal[i]);
+        INSTR_COUNT(PayoffEvals, n + 1);
+    }
+    INSTR_COUNT(NodesVisited, n + 1);
+}
+
+double CheckpointedLattice::Build(Option& Opt_, BinModel Model_, bool American_)
+{
+    Opt = &Opt_;
+    Model = Model_;
+    American = American_;
+    N = Opt->GetN();
+    Spacing = Every > 0 ? Every : max(1, (int)ceil(sqrt((double)N)));
+    Saved.assign(N + 1, vector<double>());
+    Segment.clear();
+    SegmentBase = -1;
+    Recomputed = 0;
+
+    vector<double> Price(N + 1), Next(N + 1), Stock(N + 1), ExVal(N + 1);
+    INSTR_COUNT(Allocations, 4);
+    Model.SLayer(N, Stock.data());
+    Opt->PayoffBatch(Stock.data(), Price.data(), N + 1);
+    Saved[N] = Price;
+    for (int n = N - 1; n >= 0; n--)
+    {
+        swap(Price, Next);
+        Step(n, Next.data(), Price.data(), Stock, ExVal);
+        if (n % Spacing == 0)
+            Saved[n].assign(Price.begin(), Price.begin() + n + 1);
+    }
+    return Price[0];
+}
+
+const double* CheckpointedLattice::Layer(int n)
+{
+    if (!Saved[n].empty())
+        return Saved[n].data();
+    int Base = n / Spacing * Spacing;
+    if (Base != SegmentBase)
+    {
+        // layers Base+1..Top-1 from the checkpoint Top above them
+        int Top = min(Base + Spacing, N);
+        Segment.resize(Top - Base - 1);
+        vector<double> Stock(N + 1), ExVal(N + 1);
+        const double* Next = Saved[Top].data();
+        for (int m = Top - 1; m > Base; m--)
+        {
+            vector<double>& Out = Segment[m - Base - 1];
+            Out.resize(m + 1);
+            Step(m, Next, Out.data(), Stock, ExVal);
+            Next = Out.data();
+            Recomputed++;
+        }
+        SegmentBase = Base;
+    }
+    return Segment[n - SegmentBase - 1].data();
+}
+
+double CheckpointedLattice::Value(int n, int i)
+{
+    return Layer(n)[i];
+}
+
+double CheckpointedLattice::Delta(int n, int i)
+{
+    if (n >= N)
+        return 0.0;
+    const double* Next = Layer(n + 1);
+    return (Next[i + 1] - Next[i]) / (Model.S(n + 1, i + 1) - Model.S(n + 1, i));
+}
+
+bool CheckpointedLattice::Exercise(int n, int i)
+{
+    double Intrinsic = Opt->Payoff(Model.S(n, i));
+    if (!American || Intrinsic <= 0.0)
+        return false;
+    if (n == N)
+        return true;
+    const double* Next = Layer(n + 1);
+    double q = Model.RiskNeutProb();
+    double ContVal = (q * Next[i + 1] + (1 - q) * Next[i]) / (1 + Model.GetR());
+    return Intrinsic >= ContVal;
+}
+
+void CheckpointedLattice::Answer(vector<NodeQuery>& Queries)
+{
+    // by the layer each query reads, from expiry down, so that every
+    // segment is recomputed at most once
+    vector<int> Order(Queries.size());
+    for (size_t k = 0; k < Order.size(); k++)
+        Order[k] = k;
+    auto Reads = [&](const NodeQuery& Q)
+    {
+        return Q.Kind == NodeValue || Q.n >= N ? Q.n : Q.n + 1;
+    };
+    sort(Order.begin(), Order.end(), [&](int a, int b)
+    {
+        int La = Reads(Queries[a]), Lb = Reads(Queries[b]);
+        return La != Lb ? La > Lb : Queries[a].i < Queries[b].i;
+    });
+    for (int k : Order)
+    {
+        NodeQuery& Q = Queries[k];
+        if (Q.Kind == NodeValue)
+            Q.Result = Value(Q.n, Q.i);
+        else if (Q.Kind == NodeDelta)
+            Q.Result = Delta(Q.n, Q.i);
+        else
+            Q.Result = Exercise(Q.n, Q.i) ? 1.0 : 0.0;
+    }
+}
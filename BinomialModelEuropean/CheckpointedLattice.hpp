@@ -0,0 +1,63 @@
+#ifndef CheckpointedLattice_hpp
+#define CheckpointedLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+enum NodeQueryKind
+{
+    NodeValue = 0,
+    NodeDelta,
+    NodeExercise
+};
+
+struct NodeQuery
+{
+    int n;
+    int i;
+    NodeQueryKind Kind;
+    double Result; // exercise decisions are 1 or 0
+};
+
+// The whole price lattice of one contract at O(N sqrt(N)) memory.
+//
+// Build() runs the backward induction once and keeps every k-th layer
+// (k about sqrt(N)). A query for a layer in between recomputes the k-1
+// layers of its segment from the checkpoint above and keeps them until a
+// query needs another segment. Answer() sorts a batch by segment, so a
+// hedge backtest along many paths recomputes each segment once.
+class CheckpointedLattice
+{
+private:
+    Option* Opt;
+    BinModel Model;
+    bool American;
+    int N;
+    int Every; // as set, 0 for about sqrt(N)
+    int Spacing; // the one Build() used
+    std::vector<std::vector<double>> Saved; // checkpoint layers, others empty
+    int SegmentBase; // Segment[m] is layer SegmentBase+1+m
+    std::vector<std::vector<double>> Segment;
+    long long Recomputed;
+    // one backward step from layer n+1 (Next) to layer n (Out)
+    void Step(int n, const double* Next, double* Out, std::vector<double>& Stock,
+              std::vector<double>& ExVal);
+    const double* Layer(int n);
+public:
+    CheckpointedLattice()
+        : Opt(0), American(false), N(0), Every(0), Spacing(1), SegmentBase(-1), Recomputed(0) { }
+    // checkpoint spacing, 0 for about sqrt(N)
+    void SetEvery(int Every_) { Every = Every_; }
+    // pricing and keeping the checkpoints, returns the price
+    double Build(Option& Opt_, BinModel Model_, bool American_);
+    double Value(int n, int i);
+    // hedge ratio at node (n,i) for the step to layer n+1
+    double Delta(int n, int i);
+    // American only: whether node (n,i) is exercised
+    bool Exercise(int n, int i);
+    // answering a batch in segment order; results go into the queries
+    void Answer(std::vector<NodeQuery>& Queries);
+    // layers recomputed since Build()
+    long long GetRecomputed() { return Recomputed; }
+};
+#endif
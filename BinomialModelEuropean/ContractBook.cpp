@@ -0,0 +1,168 @@
+#include "ContractBook.hpp"
+#include "PayoffFactory.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+using namespace std;
+
+namespace
+{
+    // everything that identifies a contract, hashed as bytes
+    struct BookKey
+    {
+        int Model;
+        int N;
+        int American;
+        int Kind;
+        double K1;
+        double K2;
+        bool operator==(const BookKey& Other) const
+        {
+            return Model == Other.Model && N == Other.N && American == Other.American
+                && Kind == Other.Kind && K1 == Other.K1 && K2 == Other.K2;
+        }
+    };
+
+    // 64 bit FNV-1a, as HashSnapshotKey()
+    struct BookKeyHash
+    {
+        size_t operator()(const BookKey& Key) const
+        {
+            const unsigned char* p = (const unsigned char*)&Key;
+            unsigned long long h = 14695981039346656037ULL;
+            for (size_t k = 0; k < sizeof(Key); k++)
+            {
+                h ^= p[k];
+                h *= 1099511628211ULL;
+            }
+            return (size_t)h;
+        }
+    };
+
+    // value today of 1 paid at each leaf of a lattice of N steps, the
+    // binomial weights taken in logs as in PriceByExpectation()
+    void LeafWeights(BinModel& Model, int N, double* W)
+    {
+        double q = Model.RiskNeutProb();
+        double LogW = N * log(1 - q) - N * log(1 + Model.GetR());
+        for (int i = 0; i <= N; i++)
+        {
+            W[i] = exp(LogW);
+            if (i < N)
+                LogW += log(q) - log(1 - q) + log((double)(N - i) / (i + 1));
+        }
+    }
+}
+
+int ContractBook::Add(PayoffKind Kind_, double K1_, double K2_, int N_, int Model_, bool American_)
+{
+    if (Kind_ < CallPayoff || Kind_ > BearSpreadPayoff || N_ < 1)
+        return 1;
+    // single-strike payoffs ignore K2, so it must not tell contracts apart
+    if (Kind_ == CallPayoff || Kind_ == PutPayoff)
+        K2_ = 0.0;
+    Kind.push_back(Kind_);
+    // + 0.0 turns -0.0 into 0.0, which hashes differently
+    K1.push_back(K1_ + 0.0);
+    K2.push_back(K2_ + 0.0);
+    N.push_back(N_);
+    ModelIx.push_back(Model_);
+    American.push_back(American_);
+    return 0;
+}
+
+void ContractBook::Clear()
+{
+    Kind.clear();
+    K1.clear();
+    K2.clear();
+    N.clear();
+    ModelIx.clear();
+    American.clear();
+}
+
+int ContractBook::Price(vector<BinModel>& Models, vector<double>& Prices)
+{
+    int Size = (int)Kind.size();
+    Prices.assign(Size, NAN);
+    for (int k = 0; k < Size; k++)
+        if (ModelIx[k] < 0 || ModelIx[k] >= (int)Models.size())
+            return 1;
+    // distinct contracts, and the distinct contract of each entry
+    vector<BookKey> Keys;
+    vector<int> Of(Size);
+    unordered_map<BookKey, int, BookKeyHash> Seen;
+    Seen.reserve(Size);
+    for (int k = 0; k < Size; k++)
+    {
+        BookKey Key = {ModelIx[k], N[k], American[k], Kind[k], K1[k], K2[k]};
+        auto It = Seen.emplace(Key, (int)Keys.size());
+        if (It.second)
+            Keys.push_back(Key);
+        Of[k] = It.first->second;
+    }
+    Unique = (int)Keys.size();
+    vector<int> Order(Unique);
+    for (int u = 0; u < Unique; u++)
+        Order[u] = u;
+    sort(Order.begin(), Order.end(), [&](int a, int b)
+    {
+        const BookKey& A = Keys[a];
+        const BookKey& B = Keys[b];
+        if (A.Model != B.Model) return A.Model < B.Model;
+        if (A.N != B.N) return A.N < B.N;
+        if (A.American != B.American) return A.American < B.American;
+        return A.Kind < B.Kind;
+    });
+    vector<double> UniquePrice(Unique);
+    vector<double> Stock, Weights, Pay;
+    INSTR_COUNT(Allocations, 6);
+    // model and N of the shared European layers, -1 before the first
+    int LayerModel = -1, LayerN = -1;
+    Groups = 0;
+    for (int g = 0; g < Unique; )
+    {
+        const BookKey& Head = Keys[Order[g]];
+        int End = g + 1;
+        while (End < Unique && Keys[Order[End]].Model == Head.Model && Keys[Order[End]].N == Head.N
+               && Keys[Order[End]].American == Head.American && Keys[Order[End]].Kind == Head.Kind)
+            End++;
+        Groups++;
+        BinModel& Model = Models[Head.Model];
+        int Steps = Head.N;
+        if (!Head.American && (LayerModel != Head.Model || LayerN != Steps))
+        {
+            Stock.resize(Steps + 1);
+            Weights.resize(Steps + 1);
+            Pay.resize(Steps + 1);
+            Model.SLayer(Steps, Stock.data());
+            LeafWeights(Model, Steps, Weights.data());
+            LayerModel = Head.Model;
+            LayerN = Steps;
+        }
+        // one payoff object for the group, only the strikes change
+        Option* Opt = MakePayoff((PayoffKind)Head.Kind, Head.K1, Head.K2, Steps);
+        for (int j = g; j < End; j++)
+        {
+            const BookKey& Key = Keys[Order[j]];
+            Opt->SetStrikes(Key.K1, Key.K2);
+            if (Head.American)
+                UniquePrice[Order[j]] = dynamic_cast<AmOption*>(Opt)->PriceBySnell(Model);
+            else
+            {
+                Opt->PayoffBatch(Stock.data(), Pay.data(), Steps + 1);
+                INSTR_COUNT(PayoffEvals, Steps + 1);
+                double Sum = 0.0;
+                for (int i = 0; i <= Steps; i++)
+                    Sum += Weights[i] * Pay[i];
+                UniquePrice[Order[j]] = Sum;
+            }
+        }
+        delete Opt;
+        g = End;
+    }
+    for (int k = 0; k < Size; k++)
+        Prices[k] = UniquePrice[Of[k]];
+    return 0;
+}
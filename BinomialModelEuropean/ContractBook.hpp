@@ -0,0 +1,43 @@
+#ifndef ContractBook_hpp
+#define ContractBook_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+// A book of contracts held as columns: payoff class, strikes, steps,
+// model and exercise, one entry of each per contract.
+//
+// Price() hashes every contract and prices each distinct one once. The
+// distinct contracts are sorted by model, N, exercise and payoff class,
+// and each group goes to its engine in one call, on one payoff object
+// whose strikes are reset per contract. European contracts that share a
+// model and N share one stock layer and one layer of discounted leaf
+// probabilities, so each costs a payoff evaluation and a dot product
+// instead of a lattice. American contracts each run PriceBySnell(). The
+// prices are written back in book order.
+class ContractBook
+{
+private:
+    std::vector<int> Kind;
+    std::vector<double> K1;
+    std::vector<double> K2;
+    std::vector<int> N;
+    std::vector<int> ModelIx;
+    std::vector<char> American;
+    int Unique; // distinct contracts of the last Price()
+    int Groups; // groups of the last Price()
+public:
+    ContractBook() : Unique(0), Groups(0) { }
+    // appending a contract on Models[Model_] of Price(); K2 is ignored for
+    // single-strike payoffs; returns 1 unless Kind_ is a payoff class of
+    // the library other than UserPayoff, or if N < 1
+    int Add(PayoffKind Kind_, double K1_, double K2_, int N_, int Model_, bool American_);
+    int Size() { return (int)Kind.size(); }
+    void Clear();
+    // pricing every contract into Prices, in the order added; returns 1
+    // if a contract refers to a model not in Models
+    int Price(std::vector<BinModel>& Models, std::vector<double>& Prices);
+    int GetUnique() { return Unique; }
+    int GetGroups() { return Groups; }
+};
+#endif
@@ -20,4 +20,9 @@ double DoubDigitOpt::Payoff(double z)
     if (K1 < z && z < K2)
         return 1.0;
     return 0.0;
-}
\ No newline at end of file
+}
+void DoubDigitOpt::PayoffBatch(const double* z, double* Out, int n)
+{
+    for (int i = 0; i < n; i++)
+        Out[i] = (K1 < z[i]) & (z[i] < K2) ? 1.0 : 0.0;
+}
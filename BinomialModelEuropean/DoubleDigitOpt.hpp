@@ -1,13 +1,19 @@
 #ifndef DoubDigitOpt_hpp
 #define DoubDigitOpt_hpp
 #include "OptionsEuropean.hpp"
-class DoubDigitOpt : public EurOption
+class DoubDigitOpt : public EurOption, public AmOption
 {
 private:
     double K1; // parameter 1
     double K2; // parameter 2
 public:
+    void SetK1(double K1_) { K1 = K1_; }
+    void SetK2(double K2_) { K2 = K2_; }
     int GetInputData();
     double Payoff(double z);
+    void PayoffBatch(const double* z, double* Out, int n);
+    PayoffKind GetKind() { return DoubDigitPayoff; }
+    void GetStrikes(double& K1_, double& K2_) { K1_ = K1; K2_ = K2; }
+    void SetStrikes(double K1_, double K2_) { K1 = K1_; K2 = K2_; }
 };
 #endif
\ No newline at end of file
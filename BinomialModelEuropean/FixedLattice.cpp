@@ -0,0 +1,109 @@
+#include "FixedLattice.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+using namespace std;
+
+namespace
+{
+    // Kind is CallPayoff or PutPayoff for an inline payoff with strike K,
+    // anything else goes through PayoffBatch()
+    template <int Kind>
+    inline void Exercise(Option& Opt, double K, const double* Stock, double* Out, int n)
+    {
+        if (Kind == CallPayoff)
+            for (int i = 0; i < n; i++)
+                Out[i] = max(Stock[i] - K, 0.0);
+        else if (Kind == PutPayoff)
+            for (int i = 0; i < n; i++)
+                Out[i] = max(K - Stock[i], 0.0);
+        else
+            Opt.PayoffBatch(Stock, Out, n);
+    }
+
+    template <int N, int Kind>
+    double FixedLattice(Option& Opt, BinModel& Model, bool American)
+    {
+        double q = Model.RiskNeutProb();
+        double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+        double K, K2;
+        Opt.GetStrikes(K, K2);
+        // two layers taken in turn and nodes taken in pairs, so that each
+        // pair is one vector operation; a layer of n+1 nodes may compute
+        // a spare node n+1 from entries the previous layer never wrote, so
+        // both layers start out zero
+        double Layer[2][N + 3] = {}, Stock[N + 2] = {}, ExVal[N + 2];
+        Model.SLayer(N, Stock);
+        Exercise<Kind>(Opt, K, Stock, Layer[N & 1], N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+        if (!American)
+        {
+            for (int n = N - 1; n >= 0; n--)
+            {
+                const double* Next = Layer[(n + 1) & 1];
+                double* Cur = Layer[n & 1];
+                for (int i = 0; i <= n; i += 2)
+                {
+                    Cur[i] = Up * Next[i + 1] + Down * Next[i];
+                    Cur[i + 1] = Up * Next[i + 2] + Down * Next[i + 1];
+                }
+            }
+            INSTR_COUNT(NodesVisited, N * (N + 1) / 2);
+            return Layer[0][0];
+        }
+        // S(n,i) = S(n+1,i)/(1+D) on a lattice without dividends; the
+        // product drifts from SLayer() by a few ulps per layer, which only
+        // the continuous call and put payoffs can absorb, so any other
+        // payoff takes SLayer() and sees exactly the nodes of the loops
+        bool Plain = !Model.HasDividends() && (Kind == CallPayoff || Kind == PutPayoff);
+        double InvD = 1 / (1 + Model.GetD());
+        for (int n = N - 1; n >= 0; n--)
+        {
+            if (Plain)
+                for (int i = 0; i <= n + 1; i++)
+                    Stock[i] *= InvD;
+            else
+                Model.SLayer(n, Stock);
+            Exercise<Kind>(Opt, K, Stock, ExVal, n + 2);
+            const double* Next = Layer[(n + 1) & 1];
+            double* Cur = Layer[n & 1];
+            for (int i = 0; i <= n; i += 2)
+            {
+                Cur[i] = max(ExVal[i], Up * Next[i + 1] + Down * Next[i]);
+                Cur[i + 1] = max(ExVal[i + 1], Up * Next[i + 2] + Down * Next[i + 1]);
+            }
+        }
+        INSTR_COUNT(NodesVisited, N * (N + 1) / 2);
+        INSTR_COUNT(PayoffEvals, N * (N + 1) / 2);
+        return Layer[0][0];
+    }
+
+    template <int N>
+    double FixedKind(Option& Opt, BinModel& Model, bool American)
+    {
+        switch (Opt.GetKind())
+        {
+        case CallPayoff:
+            return FixedLattice<N, CallPayoff>(Opt, Model, American);
+        case PutPayoff:
+            return FixedLattice<N, PutPayoff>(Opt, Model, American);
+        default:
+            return FixedLattice<N, UserPayoff>(Opt, Model, American);
+        }
+    }
+}
+
+int PriceFixedN(Option& Opt, BinModel& Model, bool American, double& Price)
+{
+    switch (Opt.GetN())
+    {
+    case 8: Price = FixedKind<8>(Opt, Model, American); return 0;
+    case 16: Price = FixedKind<16>(Opt, Model, American); return 0;
+    case 25: Price = FixedKind<25>(Opt, Model, American); return 0;
+    case 32: Price = FixedKind<32>(Opt, Model, American); return 0;
+    case 50: Price = FixedKind<50>(Opt, Model, American); return 0;
+    case 64: Price = FixedKind<64>(Opt, Model, American); return 0;
+    case 100: Price = FixedKind<100>(Opt, Model, American); return 0;
+    case 128: Price = FixedKind<128>(Opt, Model, American); return 0;
+    default: return 1;
+    }
+}
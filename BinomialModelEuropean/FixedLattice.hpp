@@ -0,0 +1,21 @@
+#ifndef FixedLattice_hpp
+#define FixedLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+// Lattices compiled for a fixed number of steps, for quoting small trees.
+//
+// With N a template parameter the layers live in arrays on the stack,
+// every loop bound is a constant the compiler can unroll, and there is
+// no allocation. For calls and puts the stock layers step back by one
+// multiplication per node instead of a pow per layer (dividends and the
+// other payoffs take the general SLayer()), and they are exercised inline
+// rather than through PayoffBatch(). PriceByCRR() and PriceBySnell() try
+// these kernels first, so they are used whenever N is one of FixedSteps;
+// prices agree with the general loops to rounding, which MainKernelCheck
+// verifies for every payoff class.
+const int FixedSteps[] = {8, 16, 25, 32, 50, 64, 100, 128};
+
+// price by the kernel for Opt.GetN() steps; returns 1 if there is none
+int PriceFixedN(Option& Opt, BinModel& Model, bool American, double& Price);
+#endif
@@ -0,0 +1,213 @@
+#include "FloatLattice.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    // nodes First..End-1 of a layer of n steps, both multiples of 4, carry
+    // all but a binomial tail below 2 e^-24 of the probability: Bernstein's
+    // inequality for a deviation t = 8 sd + 16 gives exp(-t^2 / (2 var +
+    // 2t/3)) with the exponent at least 24. End may run past node n into
+    // the padding
+    void Band(int n, double q, int& First, int& End)
+    {
+        double Width = 8 * sqrt(n * q * (1 - q)) + 16;
+        First = max(0, (int)floor(n * q - Width)) / 4 * 4;
+        End = (min(n, (int)ceil(n * q + Width)) + 4) / 4 * 4;
+    }
+
+    // values that would turn denormal are flushed to zero, so the tails of
+    // a layer never take the slow path of the floating-point unit
+    inline float Flush(float v)
+    {
+        return fabs(v) < FLT_MIN ? 0.0f : v;
+    }
+
+    // nodes From..To-1 of a layer from the layer above in float, in groups
+    // of four nodes, each group one vector operation; the last group may
+    // run past To
+    void Average(const float* Next, float* Cur, float q, float p, int From, int To)
+    {
+        for (int i = From; i < To; i += 4)
+        {
+            float a0 = Next[i], a1 = Next[i + 1], a2 = Next[i + 2];
+            float a3 = Next[i + 3], a4 = Next[i + 4];
+            Cur[i] = Flush(q * a1 + p * a0);
+            Cur[i + 1] = Flush(q * a2 + p * a1);
+            Cur[i + 2] = Flush(q * a3 + p * a2);
+            Cur[i + 3] = Flush(q * a4 + p * a3);
+        }
+    }
+
+    // nodes From..To-1 of a European layer in double from the float layer
+    // above, rounded to float, in groups of four. E[i] takes the error of
+    // node i to first order: its own rounding plus what reaches it from
+    // the layer above
+    void BandEur(const float* Next, float* Cur, double* E, double q, double p, int From, int To)
+    {
+        for (int i = From; i < To; i += 4)
+        {
+            double a0 = Next[i], a1 = Next[i + 1], a2 = Next[i + 2];
+            double a3 = Next[i + 3], a4 = Next[i + 4];
+            double e0 = E[i], e1 = E[i + 1], e2 = E[i + 2], e3 = E[i + 3], e4 = E[i + 4];
+            double c0 = q * a1 + p * a0, c1 = q * a2 + p * a1;
+            double c2 = q * a3 + p * a2, c3 = q * a4 + p * a3;
+            float v0 = c0, v1 = c1, v2 = c2, v3 = c3;
+            Cur[i] = v0;
+            Cur[i + 1] = v1;
+            Cur[i + 2] = v2;
+            Cur[i + 3] = v3;
+            E[i] = q * e1 + p * e0 + (c0 - v0);
+            E[i + 1] = q * e2 + p * e1 + (c1 - v1);
+            E[i + 2] = q * e3 + p * e2 + (c2 - v2);
+            E[i + 3] = q * e4 + p * e3 + (c3 - v3);
+        }
+    }
+
+    // one node of an American layer against its exercise value x, from its
+    // children a0, a1 and their errors e0, e1 and bounds b0, b1. e takes the
+    // error to first order as in BandEur() and b bounds what e misses,
+    // above all where an error can flip the exercise decision because the
+    // continuation is within it of x
+    inline void AmNode(double a0, double a1, double e0, double e1, double b0, double b1,
+                       double x, double q, double p, float& v, double& e, double& b)
+    {
+        double c = q * a1 + p * a0;
+        double Ec = q * e1 + p * e0;
+        double Bc = q * b1 + p * b0;
+        bool Exercise = x > c;
+        double w = Exercise ? x : c;
+        Bc = Exercise ? max(0.0, c + Ec + Bc - x) : max(Bc, x - c - Ec);
+        Ec = Exercise ? 0.0 : Ec;
+        v = (float)w;
+        e = Ec + (w - v);
+        b = Bc + 4 * DBL_EPSILON * (fabs(w) + fabs(Ec));
+    }
+
+    // nodes From..To-1 of an American layer by AmNode(), in groups of four,
+    // X[k] the exercise value of node From+k
+    void BandAm(const float* Next, float* Cur, double* E, double* B, const double* X,
+                double q, double p, int From, int To)
+    {
+        for (int i = From; i < To; i += 4)
+        {
+            double a0 = Next[i], a1 = Next[i + 1], a2 = Next[i + 2];
+            double a3 = Next[i + 3], a4 = Next[i + 4];
+            double e0 = E[i], e1 = E[i + 1], e2 = E[i + 2], e3 = E[i + 3], e4 = E[i + 4];
+            double b0 = B[i], b1 = B[i + 1], b2 = B[i + 2], b3 = B[i + 3], b4 = B[i + 4];
+            const double* x = X + (i - From);
+            AmNode(a0, a1, e0, e1, b0, b1, x[0], q, p, Cur[i], E[i], B[i]);
+            AmNode(a1, a2, e1, e2, b1, b2, x[1], q, p, Cur[i + 1], E[i + 1], B[i + 1]);
+            AmNode(a2, a3, e2, e3, b2, b3, x[2], q, p, Cur[i + 2], E[i + 2], B[i + 2]);
+            AmNode(a3, a4, e3, e4, b3, b4, x[3], q, p, Cur[i + 3], E[i + 3], B[i + 3]);
+        }
+    }
+}
+
+double FloatLattice::Induct(Option& Opt, BinModel& Model, bool American, double& Bound)
+{
+    int N = Opt.GetN();
+    double q = Model.RiskNeutProb(), p = 1 - q;
+    double Growth = 1 + Model.GetR();
+    // two float layers taken in turn and padded for the last group; E and
+    // B are double and hold the layer above over its band Lo..Hi-1 only
+    vector<float> Layer[2];
+    Layer[0].assign(N + 5, 0.0f);
+    Layer[1].assign(N + 5, 0.0f);
+    vector<double> Stock(N + 5), ExVal(N + 5), E(N + 5, 0.0), B(American ? N + 5 : 0, 0.0);
+    INSTR_COUNT(Allocations, 6);
+    double Neg = 0.0; // the most negative payoff, as a positive number
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        Opt.PayoffBatch(Stock.data(), ExVal.data(), N + 1);
+        float* W = Layer[N & 1].data();
+        for (int i = 0; i <= N; i++)
+        {
+            W[i] = Flush((float)ExVal[i]);
+            E[i] = ExVal[i] - W[i];
+            Neg = max(Neg, -ExVal[i]);
+        }
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    int Lo = 0, Hi = N + 1;
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            const float* Next = Layer[(n + 1) & 1].data();
+            float* Cur = Layer[n & 1].data();
+            int First, End;
+            Band(n, q, First, End);
+            // nodes of the layer above that the band reads but that were
+            // outside its own band are not tracked; their float error is
+            // left out with the tail
+            for (int j = First; j < min(Lo, End + 1); j++)
+            {
+                E[j] = 0.0;
+                if (American)
+                    B[j] = 0.0;
+            }
+            for (int j = max(Hi, First); j <= End; j++)
+            {
+                E[j] = 0.0;
+                if (American)
+                    B[j] = 0.0;
+            }
+            Average(Next, Cur, (float)q, (float)p, 0, First);
+            Average(Next, Cur, (float)q, (float)p, End, n + 1);
+            if (American)
+            {
+                // values are in units of expiry, so exercise values are
+                // grown by (1+R)^(N-n) and nothing is discounted on the way
+                double G = pow(Growth, N - n);
+                Model.SLayer(n, Stock.data());
+                Opt.PayoffBatch(Stock.data() + First, ExVal.data(), End - First);
+                for (int k = 0; k < End - First; k++)
+                    ExVal[k] *= G;
+                BandAm(Next, Cur, E.data(), B.data(), ExVal.data(), q, p, First, End);
+                INSTR_COUNT(PayoffEvals, End - First);
+            }
+            else
+                BandEur(Next, Cur, E.data(), q, p, First, End);
+            Lo = First;
+            Hi = End;
+        }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+    }
+    double Value = Layer[0][0] + E[0];
+    double Disc = pow(Growth, -N);
+    if (American)
+        Bound = B[0] * Disc;
+    else
+    {
+        // the double arithmetic of a band node is off by at most 8 epsilon
+        // of its inputs; weighted by the probability of each node a layer
+        // adds 8 epsilon times the expected absolute payoff, which is at
+        // most the price plus twice the most negative payoff
+        Bound = 8 * DBL_EPSILON * N * (fabs(Value) + 2 * Neg) * Disc;
+    }
+    return Value * Disc;
+}
+
+double FloatLattice::Price(Option& Opt, BinModel Model, bool American)
+{
+    double Bound;
+    double Price = Induct(Opt, Model, American, Bound);
+    ErrorBound = Bound;
+    FellBack = !(Bound <= Tol * fabs(Price)) || !isfinite(Price);
+    if (!FellBack)
+        return Price;
+    Fallbacks++;
+    if (American)
+    {
+        AmOption* Am = dynamic_cast<AmOption*>(&Opt);
+        return Am ? Am->PriceBySnell(Model) : NAN;
+    }
+    EurOption* Eur = dynamic_cast<EurOption*>(&Opt);
+    return Eur ? Eur->PriceByCRR(Model) : NAN;
+}
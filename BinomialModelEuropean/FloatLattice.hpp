@@ -0,0 +1,41 @@
+#ifndef FloatLattice_hpp
+#define FloatLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+// Lattice with layers stored in single precision, half the bytes per
+// node of PriceByCRR()/PriceBySnell().
+//
+// Values are kept in units of expiry (not discounted), so the induction
+// is a plain average and the discount factor is taken once in double at
+// the root; leaves and root are double. Each layer has a band of about 8
+// standard deviations around the mean path, outside which the lattice
+// ends up with probability below 2 e^-24 (Bernstein's inequality). Nodes
+// outside the band are averaged in float, in groups of four that the
+// compiler turns into vector operations, and American contracts are not
+// exercised there. Nodes in the band are computed in double, exercised,
+// and rounded to float; the rounding is carried down to the root in
+// double. It corrects a European price to the double lattice, and for an
+// American price a second sum bounds the error, since an error can flip
+// the exercise decision. If the bound exceeds SetTolerance() relative to
+// the price, the contract is priced again with double layers.
+class FloatLattice
+{
+private:
+    double Tol;
+    double ErrorBound;
+    bool FellBack;
+    long long Fallbacks;
+    double Induct(Option& Opt, BinModel& Model, bool American, double& Bound);
+public:
+    FloatLattice() : Tol(1e-6), ErrorBound(0.0), FellBack(false), Fallbacks(0) { }
+    // relative error accepted from the float layers
+    void SetTolerance(double Tol_) { Tol = Tol_; }
+    double Price(Option& Opt, BinModel Model, bool American);
+    // bound on the error of the last price from the rounding in the band,
+    // that of the float run if it fell back
+    double GetErrorBound() { return ErrorBound; }
+    bool GetFellBack() { return FellBack; }
+    long long GetFallbacks() { return Fallbacks; }
+};
+#endif
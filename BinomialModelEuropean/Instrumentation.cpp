@@ -0,0 +1,253 @@
+#include "Instrumentation.hpp"
+#ifdef BINMODEL_INSTRUMENT
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define INSTR_HAVE_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define INSTR_HAVE_TSC
+#endif
+#endif
+using namespace std;
+
+#ifdef BINMODEL_INSTRUMENT
+
+namespace
+{
+    const char* CounterNames[NumInstrCounters] = {"nodes_visited", "payoff_evals", "allocations"};
+    const char* PhaseNames[NumInstrPhases] = {"leaf_init", "induction", "greeks"};
+
+    // events kept per thread for the trace, later ones are only counted
+    const int MaxEvents = 1 << 14;
+
+    struct TraceEvent
+    {
+        int Phase;
+        unsigned long long Start;
+        unsigned long long End;
+    };
+
+    // Owned and written by one thread only. Fields are atomics accessed
+    // with relaxed order so that exporting from another thread is safe;
+    // on the owning thread this costs no more than plain loads and stores.
+    struct ThreadStats
+    {
+        int Tid;
+        atomic<unsigned long long> Count[NumInstrCounters];
+        atomic<unsigned long long> Ticks[NumInstrPhases];
+        atomic<unsigned long long> Calls[NumInstrPhases];
+        atomic<int> NumEvents;
+        atomic<unsigned long long> Dropped;
+        unique_ptr<TraceEvent[]> Events;
+        ThreadStats(int Tid_) : Tid(Tid_), NumEvents(0), Dropped(0), Events(new TraceEvent[MaxEvents])
+        {
+            for (int k = 0; k < NumInstrCounters; k++)
+                Count[k] = 0;
+            for (int k = 0; k < NumInstrPhases; k++)
+            {
+                Ticks[k] = 0;
+                Calls[k] = 0;
+            }
+        }
+    };
+
+    // stats of every thread that ever recorded, kept after the thread exits
+    struct Registry
+    {
+        mutex Lock;
+        vector<unique_ptr<ThreadStats>> Threads;
+        unsigned long long Ticks0;
+        chrono::steady_clock::time_point Clock0;
+        Registry() : Ticks0(InstrTicks()), Clock0(chrono::steady_clock::now()) { }
+    };
+
+    Registry& GetRegistry()
+    {
+        static Registry R;
+        return R;
+    }
+
+    // creating the registry at start-up so that the trace origin precedes
+    // every recorded event
+    Registry& StartupRegistry = GetRegistry();
+
+    unsigned long long Since(unsigned long long Ticks0, unsigned long long t)
+    {
+        return t > Ticks0 ? t - Ticks0 : 0;
+    }
+
+    ThreadStats& Local()
+    {
+        thread_local ThreadStats* Stats = nullptr;
+        if (!Stats)
+        {
+            Registry& R = GetRegistry();
+            lock_guard<mutex> Guard(R.Lock);
+            R.Threads.emplace_back(new ThreadStats(R.Threads.size()));
+            Stats = R.Threads.back().get();
+        }
+        return *Stats;
+    }
+
+    void Bump(atomic<unsigned long long>& a, unsigned long long Amount)
+    {
+        a.store(a.load(memory_order_relaxed) + Amount, memory_order_relaxed);
+    }
+
+    // ticks per nanosecond, measured over the life of the registry
+    double TicksPerNs()
+    {
+#ifdef INSTR_HAVE_TSC
+        Registry& R = GetRegistry();
+        unsigned long long Ticks1 = InstrTicks();
+        double Ns = chrono::duration<double, nano>(chrono::steady_clock::now() - R.Clock0).count();
+        if (Ns < 1e6)
+            return 1.0;
+        return (Ticks1 - R.Ticks0) / Ns;
+#else
+        return 1.0;
+#endif
+    }
+}
+
+unsigned long long InstrTicks()
+{
+#ifdef INSTR_HAVE_TSC
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void InstrAdd(InstrCounter Counter, unsigned long long Amount)
+{
+    Bump(Local().Count[Counter], Amount);
+}
+
+void InstrRecord(InstrPhase Phase, unsigned long long Start, unsigned long long End)
+{
+    ThreadStats& S = Local();
+    Bump(S.Ticks[Phase], End - Start);
+    Bump(S.Calls[Phase], 1);
+    int k = S.NumEvents.load(memory_order_relaxed);
+    if (k < MaxEvents)
+    {
+        S.Events[k].Phase = Phase;
+        S.Events[k].Start = Start;
+        S.Events[k].End = End;
+        S.NumEvents.store(k + 1, memory_order_release);
+    }
+    else
+        Bump(S.Dropped, 1);
+}
+
+void InstrWriteChromeTrace(ostream& out)
+{
+    Registry& R = GetRegistry();
+    lock_guard<mutex> Guard(R.Lock);
+    double Scale = 1.0 / (TicksPerNs() * 1000.0); // ticks to microseconds
+    out << "{\"traceEvents\":[";
+    bool First = true;
+    unsigned long long Last = R.Ticks0;
+    for (auto& S : R.Threads)
+    {
+        int Count = S->NumEvents.load(memory_order_acquire);
+        for (int k = 0; k < Count; k++)
+        {
+            const TraceEvent& E = S->Events[k];
+            out << (First ? "\n" : ",\n") << fixed << setprecision(3)
+                << "{\"name\":\"" << PhaseNames[E.Phase] << "\",\"cat\":\"lattice\",\"ph\":\"X\""
+                << ",\"ts\":" << Since(R.Ticks0, E.Start) * Scale
+                << ",\"dur\":" << (E.End - E.Start) * Scale
+                << ",\"pid\":1,\"tid\":" << S->Tid << "}";
+            First = false;
+            if (E.End > Last)
+                Last = E.End;
+        }
+    }
+    // counter totals at the end of the trace
+    for (auto& S : R.Threads)
+    {
+        out << (First ? "\n" : ",\n") << fixed << setprecision(3)
+            << "{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << Since(R.Ticks0, Last) * Scale
+            << ",\"pid\":1,\"tid\":" << S->Tid << ",\"args\":{";
+        for (int c = 0; c < NumInstrCounters; c++)
+            out << (c ? "," : "") << "\"" << CounterNames[c] << "\":"
+                << S->Count[c].load(memory_order_relaxed);
+        out << "}}";
+        First = false;
+    }
+    out << "\n]}" << defaultfloat << setprecision(6) << endl;
+}
+
+void InstrWritePrometheus(ostream& out)
+{
+    Registry& R = GetRegistry();
+    lock_guard<mutex> Guard(R.Lock);
+    double SecondsPerTick = 1e-9 / TicksPerNs();
+    for (int c = 0; c < NumInstrCounters; c++)
+    {
+        out << "# TYPE binmodel_" << CounterNames[c] << "_total counter\n";
+        for (auto& S : R.Threads)
+            out << "binmodel_" << CounterNames[c] << "_total{thread=\"" << S->Tid << "\"} "
+                << S->Count[c].load(memory_order_relaxed) << "\n";
+    }
+    out << "# TYPE binmodel_phase_seconds_total counter\n";
+    for (auto& S : R.Threads)
+        for (int p = 0; p < NumInstrPhases; p++)
+            out << "binmodel_phase_seconds_total{phase=\"" << PhaseNames[p]
+                << "\",thread=\"" << S->Tid << "\"} " << setprecision(9)
+                << S->Ticks[p].load(memory_order_relaxed) * SecondsPerTick << "\n";
+    out << "# TYPE binmodel_phase_calls_total counter\n";
+    for (auto& S : R.Threads)
+        for (int p = 0; p < NumInstrPhases; p++)
+            out << "binmodel_phase_calls_total{phase=\"" << PhaseNames[p]
+                << "\",thread=\"" << S->Tid << "\"} "
+                << S->Calls[p].load(memory_order_relaxed) << "\n";
+    out << "# TYPE binmodel_trace_events_dropped_total counter\n";
+    for (auto& S : R.Threads)
+        out << "binmodel_trace_events_dropped_total{thread=\"" << S->Tid << "\"} "
+            << S->Dropped.load(memory_order_relaxed) << "\n";
+    out << defaultfloat << setprecision(6) << flush;
+}
+
+void InstrReset()
+{
+    Registry& R = GetRegistry();
+    lock_guard<mutex> Guard(R.Lock);
+    for (auto& S : R.Threads)
+    {
+        for (int c = 0; c < NumInstrCounters; c++)
+            S->Count[c] = 0;
+        for (int p = 0; p < NumInstrPhases; p++)
+        {
+            S->Ticks[p] = 0;
+            S->Calls[p] = 0;
+        }
+        S->NumEvents = 0;
+        S->Dropped = 0;
+    }
+}
+
+#else
+
+void InstrWriteChromeTrace(ostream& out)
+{
+    out << "{\"traceEvents\":[]}" << endl;
+}
+
+void InstrWritePrometheus(ostream& out)
+{
+    out << "# instrumentation disabled, build with -DBINMODEL_INSTRUMENT" << endl;
+}
+
+void InstrReset() { }
+
+#endif
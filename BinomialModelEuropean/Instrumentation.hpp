@@ -0,0 +1,66 @@
+#ifndef Instrumentation_hpp
+#define Instrumentation_hpp
+#include <ostream>
+
+// Counters and phase timers for the pricing engines. Building with
+// -DBINMODEL_INSTRUMENT turns them on; without it the INSTR_ macros expand
+// to nothing and the engines carry no instrumentation code at all.
+
+enum InstrCounter
+{
+    NodesVisited = 0,
+    PayoffEvals,
+    Allocations,
+    NumInstrCounters
+};
+
+enum InstrPhase
+{
+    LeafInitPhase = 0,
+    InductionPhase,
+    GreeksPhase,
+    NumInstrPhases
+};
+
+#ifdef BINMODEL_INSTRUMENT
+
+// timestamp counter where the CPU has one, steady clock nanoseconds otherwise
+unsigned long long InstrTicks();
+// adding to a counter of the calling thread
+void InstrAdd(InstrCounter Counter, unsigned long long Amount);
+// recording one completed phase of the calling thread
+void InstrRecord(InstrPhase Phase, unsigned long long Start, unsigned long long End);
+
+// timing the enclosing scope as one occurrence of a phase
+class InstrScope
+{
+private:
+    InstrPhase Phase;
+    unsigned long long Start;
+public:
+    InstrScope(InstrPhase Phase_) : Phase(Phase_), Start(InstrTicks()) { }
+    ~InstrScope() { InstrRecord(Phase, Start, InstrTicks()); }
+};
+
+#define INSTR_CONCAT2(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT2(a, b)
+#define INSTR_COUNT(Counter, Amount) InstrAdd(Counter, Amount)
+#define INSTR_PHASE(Phase) InstrScope INSTR_CONCAT(InstrScope_, __LINE__)(Phase)
+
+#else
+
+#define INSTR_COUNT(Counter, Amount) ((void)0)
+#define INSTR_PHASE(Phase) ((void)0)
+
+#endif
+
+// writing every thread's phases as complete events and the counters as
+// counter events in Chrome trace JSON (chrome://tracing, Perfetto)
+void InstrWriteChromeTrace(std::ostream& out);
+// writing per-thread counters and phase totals in Prometheus text format
+void InstrWritePrometheus(std::ostream& out);
+// zeroing all counters and timers and dropping recorded events; only
+// while no thread is recording, as the owners update their counters with
+// a plain load and store and would overwrite the reset
+void InstrReset();
+#endif
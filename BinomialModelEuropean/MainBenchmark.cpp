@@ -0,0 +1,289 @@
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include "PayoffFactory.hpp"
+#include "PricingEngines.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Microbenchmark of the pricing engines.
+//
+//   MainBenchmark [--n 16,64,256,1024,4096] [--reps 21] [--warmup 3]
+//                 [--min-sample-us 200] [--out results.json]
+//   MainBenchmark compare base.json new.json [--threshold 0.05]
+//
+// Every engine is run for every payoff class and N. Each sample times
+// enough back-to-back calls to last at least min-sample-us, so even
+// small trees are resolved in nanoseconds per call. compare exits with
+// status 1 if any case got slower than the threshold allows.
+
+namespace
+{
+    struct BenchResult
+    {
+        string Engine;
+        string Exercise;
+        string Payoff;
+        int N;
+        int Reps;
+        long long Inner;
+        double MedianNs;
+        double MadNs;
+        double NodesPerSec;
+        double BytesPerSec;
+        double Price;
+    };
+
+    double Median(vector<double> v)
+    {
+        sort(v.begin(), v.end());
+        size_t m = v.size() / 2;
+        return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2.0;
+    }
+
+    // median absolute deviation from the median, unscaled
+    double Mad(const vector<double>& v, double Med)
+    {
+        vector<double> Dev;
+        for (double x : v)
+            Dev.push_back(fabs(x - Med));
+        return Median(Dev);
+    }
+
+    vector<int> ParseList(const string& s)
+    {
+        vector<int> List;
+        stringstream ss(s);
+        string Item;
+        while (getline(ss, Item, ','))
+            if (!Item.empty())
+                List.push_back(atoi(Item.c_str()));
+        return List;
+    }
+
+    BenchResult RunCase(const PricingEngine& E, PayoffKind Kind, int N, BinModel& Model,
+                        int Reps, int Warmup, double MinSampleNs)
+    {
+        // strikes around S0 = 100 so that every payoff is non-trivial
+        double K1 = Kind == CallPayoff || Kind == PutPayoff ? 100.0 : 95.0;
+        Option* Opt = MakePayoff(Kind, K1, 105.0, N);
+        EngineContract C = MakeEngineContract(Opt);
+        volatile double Sink = 0.0;
+
+        for (int w = 0; w < Warmup; w++)
+            Sink = E.Price(C, Model);
+        // doubling the calls per sample until a sample is long enough
+        long long Inner = 1;
+        while (true)
+        {
+            auto t0 = chrono::steady_clock::now();
+            for (long long k = 0; k < Inner; k++)
+                Sink = E.Price(C, Model);
+            auto t1 = chrono::steady_clock::now();
+            if (chrono::duration<double, nano>(t1 - t0).count() >= MinSampleNs)
+                break;
+            Inner *= 2;
+        }
+
+        vector<double> Samples;
+        for (int r = 0; r < Reps; r++)
+        {
+            auto t0 = chrono::steady_clock::now();
+            for (long long k = 0; k < Inner; k++)
+                Sink = E.Price(C, Model);
+            auto t1 = chrono::steady_clock::now();
+            Samples.push_back(chrono::duration<double, nano>(t1 - t0).count() / Inner);
+        }
+
+        BenchResult Res;
+        Res.Engine = E.Name;
+        Res.Exercise = E.American ? "american" : "european";
+        Res.Payoff = PayoffName(Kind);
+        Res.N = N;
+        Res.Reps = Reps;
+        Res.Inner = Inner;
+        Res.MedianNs = Median(Samples);
+        Res.MadNs = Mad(Samples, Res.MedianNs);
+        // nodes the engine actually visited, negative when it cannot tell
+        double Nodes = (double)E.Nodes(C, Model);
+        Res.NodesPerSec = Nodes < 0 ? -1.0 : Nodes / (Res.MedianNs * 1e-9);
+        Res.BytesPerSec = Nodes < 0 || E.NodeBytes == 0 ? -1.0 : Res.NodesPerSec * E.NodeBytes;
+        Res.Price = Sink;
+        delete Opt;
+        return Res;
+    }
+
+    // a rate, or null if it is not known
+    string Rate(double x)
+    {
+        if (x < 0)
+            return "null";
+        stringstream ss;
+        ss << setprecision(10) << x;
+        return ss.str();
+    }
+
+    void WriteJson(ostream& out, const vector<BenchResult>& Results)
+    {
+        out << "{\"benchmarks\":[" << endl;
+        for (size_t k = 0; k < Results.size(); k++)
+        {
+            const BenchResult& r = Results[k];
+            out << setprecision(10)
+                << "{\"engine\":\"" << r.Engine << "\",\"exercise\":\"" << r.Exercise
+                << "\",\"payoff\":\"" << r.Payoff << "\",\"n\":" << r.N
+                << ",\"reps\":" << r.Reps << ",\"inner\":" << r.Inner
+                << ",\"median_ns\":" << r.MedianNs << ",\"mad_ns\":" << r.MadNs
+                << ",\"nodes_per_sec\":" << Rate(r.NodesPerSec)
+                << ",\"bytes_per_sec\":" << Rate(r.BytesPerSec)
+                << ",\"price\":" << r.Price << "}"
+                << (k + 1 < Results.size() ? "," : "") << endl;
+        }
+        out << "]}" << endl;
+    }
+
+    // value of "Key": in a line written by WriteJson
+    string Field(const string& Line, const string& Key)
+    {
+        size_t p = Line.find("\"" + Key + "\":");
+        if (p == string::npos)
+            return "";
+        p += Key.size() + 3;
+        if (Line[p] == '"')
+            return Line.substr(p + 1, Line.find('"', p + 1) - p - 1);
+        size_t e = Line.find_first_of(",}", p);
+        return Line.substr(p, e - p);
+    }
+
+    int ReadJson(const char* Path, map<string, BenchResult>& Results)
+    {
+        ifstream in(Path);
+        if (!in)
+        {
+            cout << "Cannot open " << Path << endl;
+            return 1;
+        }
+        string Line;
+        while (getline(in, Line))
+        {
+            if (Field(Line, "engine").empty())
+                continue;
+            BenchResult r;
+            r.Engine = Field(Line, "engine");
+            r.Exercise = Field(Line, "exercise");
+            r.Payoff = Field(Line, "payoff");
+            r.N = atoi(Field(Line, "n").c_str());
+            r.MedianNs = atof(Field(Line, "median_ns").c_str());
+            r.MadNs = atof(Field(Line, "mad_ns").c_str());
+            Results[r.Engine + "/" + r.Exercise + "/" + r.Payoff + "/" + to_string(r.N)] = r;
+        }
+        return 0;
+    }
+
+    int Compare(const char* BasePath, const char* NewPath, double Threshold)
+    {
+        map<string, BenchResult> Base, New;
+        if (ReadJson(BasePath, Base) == 1 || ReadJson(NewPath, New) == 1)
+            return 2;
+        int Regressions = 0;
+        cout << left << setw(40) << "case" << right << setw(14) << "base ns"
+             << setw(14) << "new ns" << setw(10) << "change" << endl;
+        for (auto& Entry : New)
+        {
+            auto It = Base.find(Entry.first);
+            if (It == Base.end())
+                continue;
+            const BenchResult& b = It->second;
+            const BenchResult& n = Entry.second;
+            double Change = n.MedianNs / b.MedianNs - 1.0;
+            // slower by more than the threshold and by more than the noise
+            // of both runs (MAD scaled to a standard deviation)
+            double Noise = 3.0 * 1.4826 * (b.MadNs + n.MadNs);
+            bool Regressed = Change > Threshold && n.MedianNs - b.MedianNs > Noise;
+            if (Regressed)
+                Regressions++;
+            cout << left << setw(40) << Entry.first << right << fixed << setprecision(1)
+                 << setw(14) << b.MedianNs << setw(14) << n.MedianNs
+                 << setw(9) << 100.0 * Change << "%" << (Regressed ? "  REGRESSION" : "")
+                 << defaultfloat << endl;
+        }
+        cout << Regressions << " regression(s)" << endl;
+        return Regressions > 0 ? 1 : 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 4 && strcmp(argv[1], "compare") == 0)
+    {
+        double Threshold = 0.05;
+        for (int a = 4; a + 1 < argc; a++)
+            if (strcmp(argv[a], "--threshold") == 0)
+                Threshold = atof(argv[a + 1]);
+        return Compare(argv[2], argv[3], Threshold);
+    }
+
+    vector<int> Ns = {16, 64, 256, 1024, 4096};
+    int Reps = 21;
+    int Warmup = 3;
+    double MinSampleUs = 200.0;
+    string OutPath;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        string Opt = argv[a];
+        if (Opt == "--n")
+            Ns = ParseList(argv[a + 1]);
+        else if (Opt == "--reps")
+            Reps = atoi(argv[a + 1]);
+        else if (Opt == "--warmup")
+            Warmup = atoi(argv[a + 1]);
+        else if (Opt == "--min-sample-us")
+            MinSampleUs = atof(argv[a + 1]);
+        else if (Opt == "--out")
+            OutPath = argv[a + 1];
+        else
+        {
+            cout << "Unknown option " << Opt << endl;
+            return 1;
+        }
+    }
+    if (Reps < 1)
+        Reps = 1;
+
+    // hardcoded model: S0 = 100, U = 0.01, D = -0.01, R = 0.0001
+    BinModel Model;
+    if (Model.SetData(100.0, 0.01, -0.01, 0.0001) == 1)
+        return 1;
+
+    vector<BenchResult> Results;
+    for (int e = 0; e < NumEngines; e++)
+        for (int k = CallPayoff; k <= BearSpreadPayoff; k++)
+            for (int N : Ns)
+            {
+                Results.push_back(RunCase(Engines[e], (PayoffKind)k, N, Model, Reps, Warmup,
+                                          MinSampleUs * 1000.0));
+                const BenchResult& r = Results.back();
+                cerr << r.Engine << " " << r.Exercise << " " << r.Payoff << " N=" << N
+                     << " median " << fixed << setprecision(1) << r.MedianNs << " ns"
+                     << defaultfloat << endl;
+            }
+
+    if (OutPath.empty())
+        WriteJson(cout, Results);
+    else
+    {
+        ofstream out(OutPath);
+        WriteJson(out, Results);
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include "BlackScholes.hpp"
+#include "PayoffFactory.hpp"
+#include "PricingEngines.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Accuracy against runtime of the European engines.
+//
+//   MainConvergence [--s0 100] [--sigma 0.2] [--r 0.05] [--T 1]
+//                   [--k1 95] [--k2 105] [--nmax 4096]
+//                   [--frontier frontier.csv] [--tolerances tolerances.csv]
+//
+// For each payoff class the CRR model with N steps converges to the
+// Black-Scholes price, so the analytic price is the reference. Every
+// European engine is swept over N; the frontier table lists error and
+// time per run and marks the runs no other run beats on both. The
+// tolerance table gives, per engine, the smallest N and its time whose
+// error is below each tolerance.
+
+namespace
+{
+    struct Point
+    {
+        string Payoff;
+        string Engine;
+        int N;
+        double Price;
+        double Reference;
+        double RelError;
+        double Ns;
+        bool Frontier;
+    };
+
+    // median time per call over 5 samples of at least 0.5 ms each
+    double TimeCall(const PricingEngine& E, EngineContract& C, BinModel& Model, double& Price)
+    {
+        volatile double Sink = 0.0;
+        long long Inner = 1;
+        vector<double> Samples;
+        while ((int)Samples.size() < 5)
+        {
+            auto t0 = chrono::steady_clock::now();
+            for (long long k = 0; k < Inner; k++)
+                Sink = E.Price(C, Model);
+            double Ns = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+            if (Ns < 5e5)
+                Inner *= 2;
+            else
+                Samples.push_back(Ns / Inner);
+        }
+        sort(Samples.begin(), Samples.end());
+        Price = Sink;
+        return Samples[2];
+    }
+
+    vector<int> Sweep(int NMax)
+    {
+        vector<int> Ns;
+        for (double n = 8; n <= NMax; n *= 1.25)
+            if (Ns.empty() || (int)n != Ns.back())
+                Ns.push_back((int)n);
+        if (Ns.back() != NMax)
+            Ns.push_back(NMax);
+        return Ns;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double S0 = 100.0, Sigma = 0.2, r = 0.05, T = 1.0, K1 = 95.0, K2 = 105.0;
+    int NMax = 4096;
+    string FrontierPath, TolerancePath;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        string Opt = argv[a];
+        double v = atof(argv[a + 1]);
+        if (Opt == "--s0")
+            S0 = v;
+        else if (Opt == "--sigma")
+            Sigma = v;
+        else if (Opt == "--r")
+            r = v;
+        else if (Opt == "--T")
+            T = v;
+        else if (Opt == "--k1")
+            K1 = v;
+        else if (Opt == "--k2")
+            K2 = v;
+        else if (Opt == "--nmax")
+            NMax = (int)v;
+        else if (Opt == "--frontier")
+            FrontierPath = argv[a + 1];
+        else if (Opt == "--tolerances")
+            TolerancePath = argv[a + 1];
+        else
+        {
+            cout << "Unknown option " << Opt << endl;
+            return 1;
+        }
+    }
+    if (K1 >= K2 || NMax < 8)
+    {
+        cout << "Need K1 < K2 and nmax >= 8" << endl;
+        return 1;
+    }
+
+    vector<int> Ns = Sweep(NMax);
+    vector<Point> Points;
+    for (int k = CallPayoff; k <= BearSpreadPayoff; k++)
+    {
+        PayoffKind Kind = (PayoffKind)k;
+        double Reference;
+        BSPrice(Kind, K1, K2, S0, r, Sigma, T, Reference);
+        for (int e = 0; e < NumEngines; e++)
+        {
+            if (Engines[e].American)
+                continue;
+            for (int N : Ns)
+            {
+                BinModel Model;
+                if (Model.SetCRRData(S0, Sigma, r, T, N) == 1)
+                    continue;
+                Option* Opt = MakePayoff(Kind, K1, K2, N);
+                EngineContract C = MakeEngineContract(Opt);
+                Point p;
+                p.Payoff = PayoffName(Kind);
+                p.Engine = Engines[e].Name;
+                p.N = N;
+                p.Ns = TimeCall(Engines[e], C, Model, p.Price);
+                p.Reference = Reference;
+                p.RelError = fabs(p.Price - Reference) / fabs(Reference);
+                p.Frontier = false;
+                Points.push_back(p);
+                delete Opt;
+            }
+        }
+        cerr << PayoffName(Kind) << " done" << endl;
+    }
+
+    // a run is on the frontier of its payoff if no run is both faster and
+    // more accurate
+    for (Point& p : Points)
+    {
+        p.Frontier = true;
+        for (const Point& o : Points)
+            if (o.Payoff == p.Payoff && o.Ns < p.Ns && o.RelError < p.RelError)
+            {
+                p.Frontier = false;
+                break;
+            }
+    }
+
+    ofstream FrontierFile, ToleranceFile;
+    if (!FrontierPath.empty())
+        FrontierFile.open(FrontierPath);
+    if (!TolerancePath.empty())
+        ToleranceFile.open(TolerancePath);
+    ostream& F = FrontierPath.empty() ? cout : FrontierFile;
+    ostream& Tol = TolerancePath.empty() ? cout : ToleranceFile;
+
+    F << "payoff,engine,n,price,reference,rel_error,ns,frontier" << endl;
+    for (const Point& p : Points)
+        F << p.Payoff << "," << p.Engine << "," << p.N << "," << setprecision(12)
+          << p.Price << "," << p.Reference << "," << setprecision(4) << p.RelError
+          << "," << fixed << setprecision(1) << p.Ns << defaultfloat << ","
+          << (p.Frontier ? 1 : 0) << endl;
+
+    // smallest N reaching each tolerance; the CRR error oscillates in N,
+    // so a later N may miss a tolerance an earlier one reached
+    const double Tolerances[] = {1e-2, 1e-3, 1e-4};
+    if (FrontierPath.empty())
+        Tol << endl;
+    Tol << "payoff,engine,tolerance,min_n,ns" << endl;
+    for (int k = CallPayoff; k <= BearSpreadPayoff; k++)
+        for (int e = 0; e < NumEngines; e++)
+        {
+            if (Engines[e].American)
+                continue;
+            for (double Tolerance : Tolerances)
+            {
+                const Point* Best = nullptr;
+                for (const Point& p : Points)
+                    if (p.Payoff == PayoffName((PayoffKind)k) && p.Engine == Engines[e].Name &&
+                        p.RelError <= Tolerance && (!Best || p.N < Best->N))
+                        Best = &p;
+                Tol << PayoffName((PayoffKind)k) << "," << Engines[e].Name << ","
+                    << Tolerance << ",";
+                if (Best)
+                    Tol << Best->N << "," << fixed << setprecision(1) << Best->Ns
+                        << defaultfloat << endl;
+                else
+                    Tol << "," << endl;
+            }
+        }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include "TermBinModel.hpp"
+#include "FixedLattice.hpp"
+#include "PayoffFactory.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+// Regression check of the fixed-N kernels against the general loops.
+//
+//   MainKernelCheck
+//
+// PriceByCRR() and PriceBySnell() hand the sizes in FixedSteps to their
+// kernels, so the general loops are reached through the term-structure
+// versions on a TermBinModel with the same U, D and R at every step; they
+// visit the same nodes by SLayer() and PayoffBatch(). Every payoff class,
+// both exercise styles and every kernel size are priced on a few models,
+// and any price that differs by more than rounding is listed. The exit
+// status is 1 if there was one.
+
+int main()
+{
+    struct ModelData
+    {
+        double S0, U, D, R;
+    };
+    // the last puts a node on the butterfly's midpoint, where it jumps
+    ModelData Models[] = {{100.0, 0.05, -0.04, 0.01}, {90.0, 0.02, -0.018, 0.0005},
+                          {100.0, 0.03, -0.025, 0.002}};
+    double Strikes[][2] = {{95.0, 105.0}, {80.0, 120.0}};
+    int Checked = 0, Failed = 0;
+    for (const ModelData& M : Models)
+        for (int N : FixedSteps)
+        {
+            BinModel Model;
+            Model.SetData(M.S0, M.U, M.D, M.R);
+            TermBinModel Term;
+            Term.SetData(M.S0, M.U, M.D, vector<double>(N, M.R));
+            for (int Kind = CallPayoff; Kind <= BearSpreadPayoff; Kind++)
+                for (auto& K : Strikes)
+                    for (int American = 0; American <= 1; American++)
+                    {
+                        Option* Opt = MakePayoff((PayoffKind)Kind, K[0], K[1], N);
+                        double Kernel, Loop;
+                        PriceFixedN(*Opt, Model, American, Kernel);
+                        if (American)
+                            Loop = dynamic_cast<AmOption*>(Opt)->PriceBySnell(Term);
+                        else
+                            Loop = dynamic_cast<EurOption*>(Opt)->PriceByCRR(Term);
+                        delete Opt;
+                        Checked++;
+                        if (fabs(Kernel - Loop) <= 1e-10 * (1.0 + fabs(Loop)))
+                            continue;
+                        Failed++;
+                        cout << PayoffName((PayoffKind)Kind) << (American ? " american" : " european")
+                             << " K=" << K[0] << "/" << K[1] << " S0=" << M.S0 << " N=" << N
+                             << ": kernel " << Kernel << ", loop " << Loop << endl;
+                    }
+        }
+    cout << Checked << " prices checked, " << Failed << " differ" << endl;
+    return Failed ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include "TermBinModel.hpp"
+#include "OptionsEuropean.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+// Regression check of TermBinModel::SetCurves().
+//
+//   MainTermCheck
+//
+// Whatever the volatility curve, the step rates have to compound to the
+// integral of the short rate up to maturity, and the layer times have to
+// run from 0 to the maturity. Each curve below is built and checked; the
+// first and last pieces without volatility must not lose their rate.
+// The exit status is 1 if a curve fails.
+
+int main()
+{
+    struct Curve
+    {
+        int N;
+        vector<double> Ends, Sigmas, Rates;
+    };
+    Curve Curves[] = {
+        {200, {1.0}, {0.2}, {0.05}},
+        {100, {0.5, 1.0, 2.0}, {0.3, 0.2, 0.25}, {0.02, 0.03, 0.04}},
+        {20, {0.5, 1.0}, {0.0, 0.2}, {0.05, 0.05}},
+        {200, {1.0, 1.2}, {0.2, 0.0}, {0.0, 0.04}},
+        {50, {0.5, 0.55, 1.0}, {0.2, 0.0, 0.2}, {0.01, 0.05, 0.02}},
+    };
+    int Failed = 0;
+    for (Curve& C : Curves)
+    {
+        TermBinModel Model;
+        int Rc = Model.SetCurves(100.0, C.N, C.Ends, C.Sigmas, C.Rates);
+        double Integral = 0.0, t0 = 0.0;
+        for (size_t k = 0; k < C.Ends.size(); k++)
+        {
+            Integral += C.Rates[k] * (C.Ends[k] - t0);
+            t0 = C.Ends[k];
+        }
+        double Sum = 0.0;
+        for (int n = 0; Rc == 0 && n < C.N; n++)
+            Sum += log(1 + Model.GetR(n));
+        bool Ok = Rc == 0 && fabs(Sum - Integral) <= 1e-12 && Model.GetTime(0) == 0.0
+                  && fabs(Model.GetTime(C.N) - C.Ends.back()) <= 1e-12;
+        cout << "N=" << C.N << " ends at " << C.Ends.back() << ": rc " << Rc << ", rates "
+             << Sum << " against " << Integral << (Ok ? "" : "  FAILED") << endl;
+        if (!Ok)
+            Failed++;
+    }
+    return Failed ? 1 : 0;
+}
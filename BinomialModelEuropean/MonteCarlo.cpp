@@ -0,0 +1,389 @@
+#include "MonteCarlo.hpp"
+#include "Instrumentation.hpp"
+#include "ThreadTeam.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+int AsianCall::GetInputData()
+{
+    cout << "Enter Asian call option data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter strike price K: ";
+    cin >> K;
+    cout << endl;
+    return 0;
+}
+double AsianCall::PathPayoff(const double* Path)
+{
+    int N = GetN();
+    double Sum = 0.0;
+    for (int n = 1; n <= N; n++)
+        Sum += Path[n];
+    return Payoff(Sum / N);
+}
+
+namespace
+{
+    typedef unsigned int u32;
+    typedef unsigned long long u64;
+
+    // Count uniforms in (0,1) of stream Stream: Philox4x32-10 on the
+    // counters (j, Stream, 0), four counters side by side per pass
+    void Uniforms(u64 Seed, u64 Stream, int Count, double* Out)
+    {
+        for (int j = 0; 4 * j < Count; j += 4)
+        {
+            u32 c0[4], c1[4], c2[4], c3[4];
+            for (int l = 0; l < 4; l++)
+            {
+                c0[l] = u32(j + l);
+                c1[l] = u32(Stream);
+                c2[l] = u32(Stream >> 32);
+                c3[l] = 0;
+            }
+            u32 k0 = u32(Seed), k1 = u32(Seed >> 32);
+            for (int r = 0; r < 10; r++)
+            {
+                for (int l = 0; l < 4; l++)
+                {
+                    u64 p0 = u64(0xD2511F53u) * c0[l];
+                    u64 p1 = u64(0xCD9E8D57u) * c2[l];
+                    u32 n0 = u32(p1 >> 32) ^ c1[l] ^ k0;
+                    u32 n2 = u32(p0 >> 32) ^ c3[l] ^ k1;
+                    c0[l] = n0;
+                    c1[l] = u32(p1);
+                    c2[l] = n2;
+                    c3[l] = u32(p0);
+                }
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            for (int l = 0; l < 4; l++)
+            {
+                u32 w[4] = {c0[l], c1[l], c2[l], c3[l]};
+                for (int m = 0; m < 4; m++)
+                {
+                    int Idx = 4 * (j + l) + m;
+                    if (Idx < Count)
+                        Out[Idx] = (w[m] + 0.5) * (1.0 / 4294967296.0);
+                }
+            }
+        }
+    }
+
+    // number of up moves along the path of Unif, flipped for the
+    // antithetic path
+    void Walk(const double* Unif, int N, double q, bool Flip, int* Ups)
+    {
+        Ups[0] = 0;
+        for (int n = 0; n < N; n++)
+            Ups[n + 1] = Ups[n] + ((Flip ? 1.0 - Unif[n] : Unif[n]) < q ? 1 : 0);
+    }
+
+    // sums over the samples of one block
+    struct Moments
+    {
+        double Count, X, Y, XX, YY, XY;
+    };
+
+    void Add(Moments& M, double X, double Y)
+    {
+        M.Count += 1;
+        M.X += X;
+        M.Y += Y;
+        M.XX += X * X;
+        M.YY += Y * Y;
+        M.XY += X * Y;
+    }
+
+    // mean of X corrected by the control Y with known mean EY, blocks
+    // reduced in order
+    void Finish(const vector<Moments>& Blocks, bool Control, double EY, MCResult& Result)
+    {
+        Moments T = {0, 0, 0, 0, 0, 0};
+        for (size_t b = 0; b < Blocks.size(); b++)
+        {
+            T.Count += Blocks[b].Count;
+            T.X += Blocks[b].X;
+            T.Y += Blocks[b].Y;
+            T.XX += Blocks[b].XX;
+            T.YY += Blocks[b].YY;
+            T.XY += Blocks[b].XY;
+        }
+        double n = T.Count;
+        double MX = T.X / n, MY = T.Y / n;
+        double VX = (T.XX - n * MX * MX) / (n - 1);
+        double VY = (T.YY - n * MY * MY) / (n - 1);
+        double CXY = (T.XY - n * MX * MY) / (n - 1);
+        Result.Beta = 0.0;
+        Result.Price = MX;
+        double Var = VX;
+        if (Control && VY > 0)
+        {
+            Result.Beta = CXY / VY;
+            Result.Price = MX - Result.Beta * (MY - EY);
+            Var = VX - CXY * CXY / VY;
+        }
+        Result.StdError = sqrt(max(Var, 0.0) / n);
+    }
+
+    // the lattice-priced vanilla used as control variate
+    struct ControlOption
+    {
+        Call C;
+        Put P;
+        bool IsPut;
+        double Payoff(double z) { return IsPut ? P.Payoff(z) : C.Payoff(z); }
+    };
+
+    double SetUpControl(Option& Opt, BinModel Model, ControlOption& Ctl)
+    {
+        double K1, K2;
+        Opt.GetStrikes(K1, K2);
+        if (K1 == 0.0)
+            K1 = Model.GetS0();
+        Ctl.IsPut = Opt.GetKind() == PutPayoff;
+        Ctl.C.SetK(K1);
+        Ctl.P.SetK(K1);
+        Ctl.C.SetN(Opt.GetN());
+        Ctl.P.SetN(Opt.GetN());
+        return Ctl.IsPut ? Ctl.P.PriceByExpectation(Model) : Ctl.C.PriceByExpectation(Model);
+    }
+
+    // solving the Dim x Dim system A c = b in place, returns 1 if singular
+    int Solve(vector<double>& A, vector<double>& b, int Dim)
+    {
+        for (int c = 0; c < Dim; c++)
+        {
+            int Pivot = c;
+            for (int r = c + 1; r < Dim; r++)
+                if (fabs(A[r * Dim + c]) > fabs(A[Pivot * Dim + c]))
+                    Pivot = r;
+            if (fabs(A[Pivot * Dim + c]) < 1e-300)
+                return 1;
+            for (int k = 0; k < Dim; k++)
+                swap(A[c * Dim + k], A[Pivot * Dim + k]);
+            swap(b[c], b[Pivot]);
+            for (int r = c + 1; r < Dim; r++)
+            {
+                double f = A[r * Dim + c] / A[c * Dim + c];
+                for (int k = c; k < Dim; k++)
+                    A[r * Dim + k] -= f * A[c * Dim + k];
+                b[r] -= f * b[c];
+            }
+        }
+        for (int c = Dim - 1; c >= 0; c--)
+        {
+            for (int k = c + 1; k < Dim; k++)
+                b[c] -= A[c * Dim + k] * b[k];
+            b[c] /= A[c * Dim + c];
+        }
+        return 0;
+    }
+}
+
+int MonteCarlo::Price(Option& Opt, BinModel Model, MCResult& Result)
+{
+    int N = Opt.GetN();
+    double q = Model.RiskNeutProb();
+    long long Samples = Antithetic ? Paths / 2 : Paths;
+    if (N < 1 || Samples < 2 || !(q > 0.0 && q < 1.0))
+        return 1;
+    PathOption* PathOpt = dynamic_cast<PathOption*>(&Opt);
+    ControlOption Ctl;
+    double EY = Control ? SetUpControl(Opt, Model, Ctl) : 0.0;
+    double Disc = pow(1 + Model.GetR(), -N);
+    // stock prices of every node, read through the up counts of a path
+    vector<vector<double>> Stock(N + 1);
+    for (int n = 0; n <= N; n++)
+    {
+        Stock[n].resize(n + 1);
+        Model.SLayer(n, Stock[n].data());
+    }
+    int Blocks = int((Samples + Block - 1) / Block);
+    vector<Moments> Acc(Blocks, Moments{0, 0, 0, 0, 0, 0});
+    INSTR_COUNT(Allocations, N + 2);
+    INSTR_PHASE(InductionPhase);
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, Blocks));
+    Team.Run([&](int t)
+    {
+        int First, Last;
+        Team.Split(t, 0, Blocks - 1, First, Last);
+        vector<double> Unif(N), Path(N + 1);
+        vector<int> Ups(N + 1);
+        for (int b = First; b <= Last; b++)
+        {
+            long long End = min(Samples, (long long)(b + 1) * Block);
+            for (long long s = (long long)b * Block; s < End; s++)
+            {
+                Uniforms(Seed, s, N, Unif.data());
+                double X = 0.0, Y = 0.0;
+                for (int Flip = 0; Flip <= (Antithetic ? 1 : 0); Flip++)
+                {
+                    Walk(Unif.data(), N, q, Flip == 1, Ups.data());
+                    for (int n = 0; n <= N; n++)
+                        Path[n] = Stock[n][Ups[n]];
+                    X += Disc * (PathOpt ? PathOpt->PathPayoff(Path.data()) : Opt.Payoff(Path[N]));
+                    if (Control)
+                        Y += Disc * Ctl.Payoff(Path[N]);
+                }
+                if (Antithetic)
+                {
+                    X /= 2;
+                    Y /= 2;
+                }
+                Add(Acc[b], X, Y);
+            }
+        }
+    });
+    INSTR_COUNT(NodesVisited, (unsigned long long)Samples * N * (Antithetic ? 2 : 1));
+    Finish(Acc, Control, EY, Result);
+    Result.Paths = Samples * (Antithetic ? 2 : 1);
+    return 0;
+}
+
+int MonteCarlo::PriceAmerican(Option& Opt, BinModel Model, MCResult& Result)
+{
+    int N = Opt.GetN();
+    double q = Model.RiskNeutProb();
+    long long Samples = Antithetic ? Paths / 2 : Paths;
+    if (N < 1 || Samples < 2 || !(q > 0.0 && q < 1.0))
+        return 1;
+    int Per = Antithetic ? 2 : 1;
+    long long M = Samples * Per;
+    ControlOption Ctl;
+    double EY = Control ? SetUpControl(Opt, Model, Ctl) : 0.0;
+    double Step = 1.0 / (1 + Model.GetR());
+    double S0 = Model.GetS0();
+    vector<vector<double>> Stock(N + 1);
+    for (int n = 0; n <= N; n++)
+    {
+        Stock[n].resize(n + 1);
+        Model.SLayer(n, Stock[n].data());
+    }
+    // up counts of every path, step-major so that one step is contiguous
+    vector<int> Ups((size_t)(N + 1) * M);
+    // value of each path at the current step, exercising optimally later
+    vector<double> V(M);
+    int Blocks = int((Samples + Block - 1) / Block);
+    int Dim = Degree + 1;
+    // normal equations of each block: Dim x Dim matrix then right side
+    vector<double> Normal((size_t)Blocks * (Dim * Dim + Dim));
+    vector<double> Coef(Dim);
+    bool Fitted = false;
+    vector<Moments> Acc(Blocks, Moments{0, 0, 0, 0, 0, 0});
+    INSTR_COUNT(Allocations, N + 6);
+    INSTR_PHASE(InductionPhase);
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, Blocks));
+    Team.Run([&](int t)
+    {
+        int First, Last;
+        Team.Split(t, 0, Blocks - 1, First, Last);
+        long long Lo = min(Samples, (long long)First * Block) * Per;
+        long long Hi = min(Samples, (long long)(Last + 1) * Block) * Per;
+        vector<double> Unif(N);
+        vector<int> Walked(N + 1);
+        for (long long s = Lo / Per; s < Hi / Per; s++)
+        {
+            Uniforms(Seed, s, N, Unif.data());
+            for (int Flip = 0; Flip < Per; Flip++)
+            {
+                long long m = s * Per + Flip;
+                Walk(Unif.data(), N, q, Flip == 1, Walked.data());
+                for (int n = 0; n <= N; n++)
+                    Ups[(size_t)n * M + m] = Walked[n];
+                V[m] = Opt.Payoff(Stock[N][Walked[N]]);
+            }
+        }
+        vector<double> Basis(Dim);
+        for (int n = N - 1; n >= 1; n--)
+        {
+            const int* Un = &Ups[(size_t)n * M];
+            for (int b = First; b <= Last; b++)
+            {
+                double* A = &Normal[(size_t)b * (Dim * Dim + Dim)];
+                fill(A, A + Dim * Dim + Dim, 0.0);
+                long long End = min(Samples, (long long)(b + 1) * Block) * Per;
+                for (long long m = (long long)b * Block * Per; m < End; m++)
+                {
+                    V[m] *= Step;
+                    double S = Stock[n][Un[m]];
+                    if (Opt.Payoff(S) <= 0.0)
+                        continue;
+                    double x = log(S / S0);
+                    Basis[0] = 1.0;
+                    for (int k = 1; k < Dim; k++)
+                        Basis[k] = Basis[k - 1] * x;
+                    for (int r = 0; r < Dim; r++)
+                    {
+                        for (int c = 0; c < Dim; c++)
+                            A[r * Dim + c] += Basis[r] * Basis[c];
+                        A[Dim * Dim + r] += Basis[r] * V[m];
+                    }
+                }
+            }
+            Team.Barrier();
+            if (t == 0)
+            {
+                vector<double> A(Dim * Dim, 0.0);
+                for (int k = 0; k < Dim; k++)
+                    Coef[k] = 0.0;
+                for (int b = 0; b < Blocks; b++)
+                {
+                    const double* Ab = &Normal[(size_t)b * (Dim * Dim + Dim)];
+                    for (int k = 0; k < Dim * Dim; k++)
+                        A[k] += Ab[k];
+                    for (int k = 0; k < Dim; k++)
+                        Coef[k] += Ab[Dim * Dim + k];
+                }
+                // too few paths in the money to fit: no exercise this step
+                Fitted = A[0] > Dim && Solve(A, Coef, Dim) == 0;
+            }
+            Team.Barrier();
+            if (!Fitted)
+                continue;
+            for (long long m = Lo; m < Hi; m++)
+            {
+                double S = Stock[n][Un[m]];
+                double h = Opt.Payoff(S);
+                if (h <= 0.0)
+                    continue;
+                double x = log(S / S0), Cont = 0.0;
+                for (int k = Dim - 1; k >= 0; k--)
+                    Cont = Cont * x + Coef[k];
+                if (h > Cont)
+                    V[m] = h;
+            }
+        }
+        for (int b = First; b <= Last; b++)
+        {
+            long long End = min(Samples, (long long)(b + 1) * Block);
+            for (long long s = (long long)b * Block; s < End; s++)
+            {
+                double X = 0.0, Y = 0.0;
+                for (int Flip = 0; Flip < Per; Flip++)
+                {
+                    long long m = s * Per + Flip;
+                    X += V[m] * Step;
+                    if (Control)
+                        Y += pow(Step, N) * Ctl.Payoff(Stock[N][Ups[(size_t)N * M + m]]);
+                }
+                Add(Acc[b], X / Per, Y / Per);
+            }
+        }
+    });
+    INSTR_COUNT(NodesVisited, (unsigned long long)M * N);
+    Finish(Acc, Control, EY, Result);
+    // exercising today if that beats continuing
+    Result.Price = max(Result.Price, Opt.Payoff(S0));
+    Result.Paths = M;
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef MonteCarlo_hpp
+#define MonteCarlo_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+// contract whose payoff depends on the whole path S(0),...,S(N); the
+// default is the terminal payoff, so every Option can be simulated
+class PathOption : public virtual Option
+{
+public:
+    virtual double PathPayoff(const double* Path) { return Payoff(Path[GetN()]); }
+};
+
+// arithmetic average-price call on S(1),...,S(N); Payoff() takes the
+// average
+class AsianCall : public PathOption
+{
+private:
+    double K; // strike price
+public:
+    void SetK(double K_) { K = K_; }
+    int GetInputData();
+    double Payoff(double z) { return z > K ? z - K : 0.0; }
+    double PathPayoff(const double* Path);
+    void GetStrikes(double& K1_, double& K2_) { K1_ = K; K2_ = 0.0; }
+    void SetStrikes(double K1_, double K2_) { K = K1_; }
+};
+
+struct MCResult
+{
+    double Price;
+    double StdError;
+    long long Paths; // simulated paths, both of each antithetic pair
+    double Beta;     // control variate coefficient, 0.0 without one
+};
+
+// Monte Carlo pricing under the BinModel dynamics: each step is up with
+// the risk-neutral probability q.
+//
+// Uniforms come from the counter-based Philox4x32-10 generator with the
+// sample number as the stream, so every sample is the same whatever the
+// number of threads. Samples are summed per block of SetBlock() and the
+// blocks are reduced in order, so the result is bitwise the same at any
+// thread count. The control variate is a vanilla call (a put for put
+// payoffs) at the contract's first strike, priced exactly on the lattice.
+class MonteCarlo
+{
+private:
+    unsigned long long Seed;
+    long long Paths;
+    int Threads;
+    int Block;
+    bool Antithetic;
+    bool Control;
+    int Degree;
+public:
+    MonteCarlo() : Seed(20240501ULL), Paths(100000), Threads(1), Block(4096),
+                   Antithetic(true), Control(true), Degree(3) { }
+    void SetSeed(unsigned long long Seed_) { Seed = Seed_; }
+    void SetPaths(long long Paths_) { Paths = Paths_; }
+    void SetThreads(int Threads_) { Threads = Threads_ < 1 ? 1 : Threads_; }
+    void SetBlock(int Block_) { Block = Block_ < 1 ? 1 : Block_; }
+    void SetAntithetic(bool Antithetic_) { Antithetic = Antithetic_; }
+    void SetControl(bool Control_) { Control = Control_; }
+    // degree of the polynomial in log(S/S0) used by PriceAmerican()
+    void SetDegree(int Degree_) { Degree = Degree_ < 1 ? 1 : Degree_; }
+    // European price, the payoff of a PathOption sees the whole path;
+    // returns 1 if the model is not arbitrage-free or there are too few
+    // paths
+    int Price(Option& Opt, BinModel Model, MCResult& Result);
+    // American price by Longstaff-Schwartz regression of the continuation
+    // value on in-the-money paths, exercising at Payoff(S) on every step
+    int PriceAmerican(Option& Opt, BinModel Model, MCResult& Result);
+};
+#endif
@@ -1,26 +1,108 @@
 #include "OptionsEuropean.hpp"
 #include "BinModelEuropean.hpp"
+#include "Instrumentation.hpp"
+#include "FixedLattice.hpp"
 #include <iostream>
 #include <cmath>
+#include <vector>
 using namespace std;
 double EurOption::PriceByCRR(BinModel Model)
 {
+    // small trees of a common size have a kernel of their own
+    double Fixed;
+    if (PriceFixedN(*this, Model, false, Fixed) == 0)
+        return Fixed;
     double q = Model.RiskNeutProb();
-    double Price[N + 1];
+    // discounting folded into the two weights once, not per node
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    int N = GetN();
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    INSTR_COUNT(Allocations, 2);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            for (int i = 0; i <= n; i++)
+            {
+                Price[i] = Up * Price[i + 1] + Down * Price[i];
+            }
+        }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+    }
+    return Price[0];
+}
+double EurOption::PriceByExpectation(BinModel Model)
+{
+    // binomial weights C(N,i) q^i (1-q)^(N-i) taken in logs, so that large
+    // N neither overflows nor underflows before the tails
+    double q = Model.RiskNeutProb();
+    int N = GetN();
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    INSTR_COUNT(Allocations, 2);
+    Model.SLayer(N, Stock.data());
+    PayoffBatch(Stock.data(), Price.data(), N + 1);
+    INSTR_COUNT(PayoffEvals, N + 1);
+    double LogW = N * log(1 - q) - N * log(1 + Model.GetR());
+    double Sum = 0.0;
     for (int i = 0; i <= N; i++)
-
     {
-        Price[i] = Payoff(Model.S(N, i));
+        if (Price[i] != 0.0)
+            Sum += exp(LogW) * Price[i];
+        if (i < N)
+            LogW += log(q) - log(1 - q) + log((double)(N - i) / (i + 1));
     }
-    for (int n = N - 1; n >= 0; n--)
+    return Sum;
+}
+double AmOption::PriceBySnell(BinModel Model)
+{
+    double Fixed;
+    if (PriceFixedN(*this, Model, true, Fixed) == 0)
+        return Fixed;
+    double q = Model.RiskNeutProb();
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    int N = GetN();
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    vector<double> ExVal(N + 1);
+    double ContVal;
+    INSTR_COUNT(Allocations, 3);
     {
-        for (int i = 0; i <= n; i++)
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
         {
-            Price[i] = (q * Price[i + 1] + (1 - q) * Price[i]) / (1 + Model.GetR());
+            // intrinsic values of the whole layer in one call
+            Model.SLayer(n, Stock.data());
+            PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+            for (int i = 0; i <= n; i++)
+            {
+                ContVal = Up * Price[i + 1] + Down * Price[i];
+                Price[i] = max(ExVal[i], ContVal);
+            }
         }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+        INSTR_COUNT(PayoffEvals, (unsigned long long)N * (N + 1) / 2);
     }
     return Price[0];
 }
+void Option::PayoffBatch(const double* z, double* Out, int n)
+{
+    for (int i = 0; i < n; i++)
+        Out[i] = Payoff(z[i]);
+}
 int Call::GetInputData()
 {
     cout << "Enter call option data:" << endl;
@@ -39,6 +121,11 @@ double Call::Payoff(double z)
         return z - K;
     return 0.0;
 }
+void Call::PayoffBatch(const double* z, double* Out, int n)
+{
+    for (int i = 0; i < n; i++)
+        Out[i] = z[i] > K ? z[i] - K : 0.0;
+}
 int Put::GetInputData()
 {
     cout << "Enter put option data:" << endl;
@@ -56,4 +143,9 @@ double Put::Payoff(double z)
     if (z < K)
         return K - z;
     return 0.0;
+}
+void Put::PayoffBatch(const double* z, double* Out, int n)
+{
+    for (int i = 0; i < n; i++)
+        Out[i] = z[i] < K ? K - z[i] : 0.0;
 }
\ No newline at end of file
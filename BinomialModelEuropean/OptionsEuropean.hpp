@@ -1,21 +1,62 @@
 #ifndef OptionsEuropean_hpp
 #define OptionsEuropean_hpp
 #include "BinModelEuropean.hpp"
-class EurOption
+class TermBinModel;
+// payoff classes of the library, used to identify a contract
+// independently of the object that holds it
+enum PayoffKind
+{
+    UserPayoff = 0,
+    CallPayoff,
+    PutPayoff,
+    DoubDigitPayoff,
+    StranglePayoff,
+    ButterflyPayoff,
+    BullSpreadPayoff,
+    BearSpreadPayoff
+};
+class Option
 {
 private:
     int N; // steps to expiry
 public:
+    virtual ~Option() { }
     void SetN(int N_) { N = N_; }
+    int GetN() { return N; }
     // Payoff defined to return 0.0
     // for pedagogical purposes.
     // To use a pure virtual function replace by
     // virtual double Payoff(double z)=0; 
     virtual double Payoff(double z) { return 0.0; }
+    // payoff at the n prices z[0..n-1] into Out[0..n-1], one virtual
+    // call per layer; the default calls Payoff() for each price
+    virtual void PayoffBatch(const double* z, double* Out, int n);
+    // payoff class and strikes, K2 is 0.0 for single-strike payoffs
+    // and ignored by SetStrikes() for them
+    virtual PayoffKind GetKind() { return UserPayoff; }
+    virtual void GetStrikes(double& K1_, double& K2_) { K1_ = 0.0; K2_ = 0.0; }
+    virtual void SetStrikes(double K1_, double K2_) { }
+};
+class EurOption : public virtual Option
+{
+public:
     // pricing European option
     double PriceByCRR(BinModel Model);
+    // the same price as the O(N) expectation over the leaves
+    double PriceByExpectation(BinModel Model);
+    // pricing on a term structure (TermBinModel.cpp), NaN if N exceeds
+    // the model's steps
+    double PriceByCRR(TermBinModel& Model);
+};
+class AmOption : public virtual Option
+{
+public:
+    // pricing American option
+    double PriceBySnell(BinModel Model);
+    // pricing on a term structure (TermBinModel.cpp)
+    double PriceBySnell(TermBinModel& Model);
 };
-class Call : public EurOption
+class Call : public EurOption, public AmOption
 {
 private:
     double K; // strike price
@@ -23,8 +64,12 @@ public:
     void SetK(double K_) { K = K_; }
     int GetInputData();
     double Payoff(double z);
+    void PayoffBatch(const double* z, double* Out, int n);
+    PayoffKind GetKind() { return CallPayoff; }
+    void GetStrikes(double& K1_, double& K2_) { K1_ = K; K2_ = 0.0; }
+    void SetStrikes(double K1_, double K2_) { K = K1_; }
 };
-class Put : public EurOption
+class Put : public EurOption, public AmOption
 {
 private:
     double K; // strike price
@@ -32,5 +77,9 @@ public:
     void SetK(double K_) { K = K_; }
     int GetInputData();
     double Payoff(double z);
+    void PayoffBatch(const double* z, double* Out, int n);
+    PayoffKind GetKind() { return PutPayoff; }
+    void GetStrikes(double& K1_, double& K2_) { K1_ = K; K2_ = 0.0; }
+    void SetStrikes(double K1_, double K2_) { K = K1_; }
 };
-#endif
\ No newline at end of file
+#endif
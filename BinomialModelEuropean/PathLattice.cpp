@@ -0,0 +1,215 @@
+#include "PathLattice.hpp"
+#include "Instrumentation.hpp"
+#include "ThreadTeam.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+int LookbackOption::GetInputData()
+{
+    cout << "Enter lookback option data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter 1 for a call (S(N) - min S), 0 for a put (max S - S(N)): ";
+    cin >> IsCall;
+    cout << endl;
+    return 0;
+}
+double LookbackOption::PathPayoff(const double* Path)
+{
+    int N = GetN();
+    double Lo = Path[0], Hi = Path[0];
+    for (int n = 1; n <= N; n++)
+    {
+        Lo = min(Lo, Path[n]);
+        Hi = max(Hi, Path[n]);
+    }
+    return IsCall ? Path[N] - Lo : Hi - Path[N];
+}
+
+double AsianLattice::Price(Option& Opt, BinModel Model, bool American)
+{
+    int N = Opt.GetN();
+    int M = States;
+    if (Model.HasDividends())
+        return NAN;
+    if (N < 1)
+        return Opt.Payoff(Model.GetS0());
+    double q = Model.RiskNeutProb();
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    double S0 = Model.GetS0(), u = 1 + Model.GetU(), d = 1 + Model.GetD();
+    // Gu[m] = u+...+u^m and Pu[m] = u^m give the extreme path sums: the
+    // largest average at (n,i) goes up first, the smallest down first
+    vector<double> Gu(N + 1), Gd(N + 1), Pu(N + 1), Pd(N + 1);
+    Gu[0] = Gd[0] = 0.0;
+    Pu[0] = Pd[0] = 1.0;
+    for (int m = 1; m <= N; m++)
+    {
+        Pu[m] = Pu[m - 1] * u;
+        Pd[m] = Pd[m - 1] * d;
+        Gu[m] = Gu[m - 1] + Pu[m];
+        Gd[m] = Gd[m - 1] + Pd[m];
+    }
+    // two layers of values and representative averages, node-major
+    vector<double> Val[2], Rep[2];
+    for (int p = 0; p < 2; p++)
+    {
+        Val[p].resize((size_t)(N + 1) * M);
+        Rep[p].resize((size_t)(N + 1) * M);
+    }
+    INSTR_COUNT(Allocations, 8);
+    INSTR_PHASE(InductionPhase);
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, N + 1));
+    Team.Run([&](int t)
+    {
+        vector<double> Stock(N + 2), Au(M), Ad(M), Ex(M);
+        // representative averages of node (n,i)
+        auto Reps = [&](int n, int i, double* A)
+        {
+            double Lo = S0 * (Gd[n - i] + Pd[n - i] * Gu[i]) / n;
+            double Hi = S0 * (Gu[i] + Pu[i] * Gd[n - i]) / n;
+            double Step = log(Hi / Lo) / (M - 1);
+            for (int k = 0; k < M; k++)
+                A[k] = Lo * exp(k * Step);
+            A[M - 1] = Hi;
+        };
+        // values at the averages Avg[0..M-1] of a node with
+        // representatives A and values V
+        auto Interp = [&](const double* A, const double* V, const double* Avg, double* Out)
+        {
+            double Lo = A[0], Hi = A[M - 1];
+            if (Hi <= Lo * (1 + 1e-14))
+            {
+                for (int k = 0; k < M; k++)
+                    Out[k] = V[0];
+                return;
+            }
+            double Scale = (M - 1) / log(Hi / Lo);
+            for (int k = 0; k < M; k++)
+            {
+                double Pos = log(Avg[k] / Lo) * Scale;
+                // quadratic through the three representatives nearest to
+                // the average, the middle one at j
+                int j = Pos <= 0.5 ? 1 : min(int(Pos + 0.5), M - 2);
+                double x = min(max(Avg[k], Lo), Hi);
+                double x0 = A[j - 1], x1 = A[j], x2 = A[j + 1];
+                Out[k] = V[j - 1] * (x - x1) * (x - x2) / ((x0 - x1) * (x0 - x2))
+                       + V[j] * (x - x0) * (x - x2) / ((x1 - x0) * (x1 - x2))
+                       + V[j + 1] * (x - x0) * (x - x1) / ((x2 - x0) * (x2 - x1));
+            }
+        };
+        int First, Last;
+        Team.Split(t, 0, N, First, Last);
+        for (int i = First; i <= Last; i++)
+        {
+            double* A = &Rep[N & 1][(size_t)i * M];
+            Reps(N, i, A);
+            Opt.PayoffBatch(A, &Val[N & 1][(size_t)i * M], M);
+        }
+        Team.Barrier();
+        for (int n = N - 1; n >= 1; n--)
+        {
+            const vector<double>& NextVal = Val[(n + 1) & 1];
+            const vector<double>& NextRep = Rep[(n + 1) & 1];
+            Team.Split(t, 0, n, First, Last);
+            if (First <= Last)
+                Model.SRange(n + 1, First, Last - First + 2, Stock.data());
+            for (int i = First; i <= Last; i++)
+            {
+                double* A = &Rep[n & 1][(size_t)i * M];
+                double* V = &Val[n & 1][(size_t)i * M];
+                Reps(n, i, A);
+                double Su = Stock[i - First + 1], Sd = Stock[i - First];
+                for (int k = 0; k < M; k++)
+                {
+                    Au[k] = (n * A[k] + Su) / (n + 1);
+                    Ad[k] = (n * A[k] + Sd) / (n + 1);
+                }
+                Interp(&NextRep[(size_t)(i + 1) * M], &NextVal[(size_t)(i + 1) * M], Au.data(), Au.data());
+                Interp(&NextRep[(size_t)i * M], &NextVal[(size_t)i * M], Ad.data(), Ad.data());
+                for (int k = 0; k < M; k++)
+                    V[k] = Up * Au[k] + Down * Ad[k];
+                if (American)
+                {
+                    Opt.PayoffBatch(A, Ex.data(), M);
+                    for (int k = 0; k < M; k++)
+                        V[k] = max(V[k], Ex[k]);
+                }
+            }
+            Team.Barrier();
+        }
+    });
+    INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2 * M);
+    // layer 1 has a single average per node, and there is no average to
+    // exercise at today
+    return Up * Val[1][M] + Down * Val[1][0];
+}
+
+double LookbackLattice::Price(LookbackOption& Opt, BinModel Model, bool American)
+{
+    int N = Opt.GetN();
+    if (Model.HasDividends())
+        return NAN;
+    double q = Model.RiskNeutProb();
+    double lu = log(1 + Model.GetU()), ld = log(1 + Model.GetD());
+    // probabilities under the stock numeraire, no discounting
+    double Pu = q * (1 + Model.GetU()) / (1 + Model.GetR());
+    double Pd = 1 - Pu;
+    bool IsCall = Opt.GetCall();
+    // the put tracks the maximum, which an up move approaches; the call
+    // tracks the minimum, which a down move approaches
+    double Toward = IsCall ? -ld : lu, Away = IsCall ? lu : -ld;
+    double PToward = IsCall ? Pd : Pu, PAway = IsCall ? Pu : Pd;
+    double Ratio = Away / Toward;
+    bool Exact = fabs(Ratio - floor(Ratio + 0.5)) < 1e-9;
+    int G = Refine > 0 ? Refine : (Exact ? 1 : 8);
+    double h = Toward / G;
+    double Shift = Away / h;
+    if (fabs(Shift - floor(Shift + 0.5)) < 1e-9)
+        Shift = floor(Shift + 0.5);
+    int j0 = int(floor(Shift));
+    double w = Shift - j0;
+    // grid points of layer n cover z up to n moves away
+    auto Top = [&](int n) { return int(ceil(n * Shift - 1e-9)); };
+    States = Top(N) + 1;
+    vector<double> W[2];
+    W[0].resize(States + 1);
+    W[1].resize(States + 1);
+    vector<double> Ex(States + 1);
+    for (int k = 0; k <= Top(N); k++)
+        Ex[k] = IsCall ? 1 - exp(-k * h) : exp(k * h) - 1;
+    INSTR_COUNT(Allocations, 3);
+    INSTR_PHASE(InductionPhase);
+    for (int k = 0; k <= Top(N); k++)
+        W[N & 1][k] = Ex[k];
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, States));
+    Team.Run([&](int t)
+    {
+        for (int n = N - 1; n >= 0; n--)
+        {
+            const double* Next = W[(n + 1) & 1].data();
+            double* Cur = W[n & 1].data();
+            int K = Top(n), KNext = Top(n + 1);
+            int First, Last;
+            Team.Split(t, 0, K, First, Last);
+            for (int k = First; k <= Last; k++)
+            {
+                int a = min(k + j0, KNext), b = min(k + j0 + 1, KNext);
+                double AwayVal = Next[a] + (Next[b] - Next[a]) * w;
+                Cur[k] = PToward * Next[max(k - G, 0)] + PAway * AwayVal;
+            }
+            if (American)
+                for (int k = First; k <= Last; k++)
+                    Cur[k] = max(Cur[k], Ex[k]);
+            Team.Barrier();
+        }
+    });
+    INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2 * G);
+    return Model.GetS0() * W[0][0];
+}
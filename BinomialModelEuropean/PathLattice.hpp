@@ -0,0 +1,69 @@
+#ifndef PathLattice_hpp
+#define PathLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "MonteCarlo.hpp"
+
+// floating-strike lookback: the put pays max S - S(N), the call pays
+// S(N) - min S, extremes over S(0),...,S(N)
+class LookbackOption : public PathOption
+{
+private:
+    bool IsCall;
+public:
+    LookbackOption() : IsCall(false) { }
+    void SetCall(bool IsCall_) { IsCall = IsCall_; }
+    bool GetCall() { return IsCall; }
+    int GetInputData();
+    double PathPayoff(const double* Path);
+};
+
+// Hull-White lattice for contracts on the arithmetic average of
+// S(1),...,S(n): Opt.Payoff() is applied to the average, so a Call gives
+// an average-price call.
+//
+// Every node (n,i) carries SetStates() representative averages, spaced
+// evenly in log between the smallest and largest average of the paths
+// reaching it. Stepping back, each average moves to the two successors
+// and its value is interpolated there by the quadratic through the three
+// nearest representatives; linear interpolation needs M to grow with N.
+// Values of a layer are stored node by node with the averages of a node
+// contiguous, and the nodes of a layer are split between threads. Work is
+// O(N^2 M) for M states. American exercise at the running average is
+// allowed from step 1. Both lattices here assume a geometric lattice and
+// return NaN for a model with dividends.
+class AsianLattice
+{
+private:
+    int States;
+    int Threads;
+public:
+    AsianLattice() : States(64), Threads(1) { }
+    void SetStates(int States_) { States = States_ < 3 ? 3 : States_; }
+    void SetThreads(int Threads_) { Threads = Threads_ < 1 ? 1 : Threads_; }
+    double Price(Option& Opt, BinModel Model, bool American);
+};
+
+// Cheuk-Vorst lattice for floating-strike lookbacks.
+//
+// Taking the stock as numeraire, the value is S times a function of n
+// and z = |log(extreme/S)| only, so the tree is one-dimensional in z.
+// The grid of z has SetRefine() points per move towards the extreme, so
+// that move is exact (down to 0). The move away is interpolated between
+// grid points unless it is a whole number of them, as when
+// (1+U)(1+D) = 1. Each layer's grid is split between threads.
+class LookbackLattice
+{
+private:
+    int Threads;
+    int Refine;
+    int States; // grid points of the last layer priced
+public:
+    LookbackLattice() : Threads(1), Refine(0), States(0) { }
+    void SetThreads(int Threads_) { Threads = Threads_ < 1 ? 1 : Threads_; }
+    // grid points per move towards the extreme, 0 for 1 when the grid is
+    // exact and 8 otherwise
+    void SetRefine(int Refine_) { Refine = Refine_ < 0 ? 0 : Refine_; }
+    double Price(LookbackOption& Opt, BinModel Model, bool American);
+    int GetStates() { return States; }
+};
+#endif
@@ -0,0 +1,465 @@
+#include "PayoffExpr.hpp"
+#include <iostream>
+#include <sstream>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+using namespace std;
+
+namespace
+{
+    // nodes evaluated per pass over the bytecode; small enough that all
+    // registers of a typical payoff stay in L1
+    const int Block = 64;
+
+    // an operand while compiling: a constant to fold, the stock price
+    // (register 0), a constant register or a temporary
+    struct Operand
+    {
+        enum Kind { Const, Stock, Temp } K;
+        double Value;
+        int Index; // temporary number for Temp
+    };
+
+    class Compiler
+    {
+    private:
+        const string& Src;
+        const map<string, double>& Params;
+        size_t Pos;
+        vector<int> FreeTemps;
+        int NumTemps;
+    public:
+        string Error;
+        vector<double> Consts;
+        // registers as compiled: 0 is S, 1+k is Consts[k], -1-t is temporary t
+        vector<ExprPayoff::Instr> Code;
+
+        Compiler(const string& Src_, const map<string, double>& Params_)
+            : Src(Src_), Params(Params_), Pos(0), NumTemps(0) { }
+        int GetNumTemps() { return NumTemps; }
+
+        void Fail(const string& Msg)
+        {
+            if (Error.empty())
+                Error = Msg + " at position " + to_string(Pos);
+        }
+
+        void SkipSpace()
+        {
+            while (Pos < Src.size() && isspace((unsigned char)Src[Pos]))
+                Pos++;
+        }
+
+        bool Accept(const char* Tok)
+        {
+            SkipSpace();
+            size_t Len = char_traits<char>::length(Tok);
+            if (Src.compare(Pos, Len, Tok) == 0)
+            {
+                Pos += Len;
+                return true;
+            }
+            return false;
+        }
+
+        bool AtEnd()
+        {
+            SkipSpace();
+            return Pos >= Src.size();
+        }
+
+        int RegOf(const Operand& a)
+        {
+            if (a.K == Operand::Stock)
+                return 0;
+            if (a.K == Operand::Temp)
+                return -1 - a.Index;
+            for (size_t k = 0; k < Consts.size(); k++)
+                if (Consts[k] == a.Value)
+                    return 1 + k;
+            Consts.push_back(a.Value);
+            return Consts.size();
+        }
+
+        int NewTemp()
+        {
+            if (!FreeTemps.empty())
+            {
+                int t = FreeTemps.back();
+                FreeTemps.pop_back();
+                return t;
+            }
+            return NumTemps++;
+        }
+
+        static double Fold(ExprPayoff::OpCode Op, double a, double b)
+        {
+            switch (Op)
+            {
+            case ExprPayoff::OpAdd: return a + b;
+            case ExprPayoff::OpSub: return a - b;
+            case ExprPayoff::OpMul: return a * b;
+            case ExprPayoff::OpDiv: return a / b;
+            case ExprPayoff::OpMax: return a > b ? a : b;
+            case ExprPayoff::OpMin: return a < b ? a : b;
+            case ExprPayoff::OpLt: return a < b ? 1.0 : 0.0;
+            case ExprPayoff::OpLe: return a <= b ? 1.0 : 0.0;
+            case ExprPayoff::OpGt: return a > b ? 1.0 : 0.0;
+            case ExprPayoff::OpGe: return a >= b ? 1.0 : 0.0;
+            case ExprPayoff::OpNeg: return -a;
+            case ExprPayoff::OpAbs: return fabs(a);
+            case ExprPayoff::OpInd: return a > 0.0 ? 1.0 : 0.0;
+            }
+            return 0.0;
+        }
+
+        // emitting Op, writing into a temporary operand where possible so
+        // that registers are reused along the expression tree
+        Operand Emit(ExprPayoff::OpCode Op, Operand a, Operand b, bool Unary)
+        {
+            if (a.K == Operand::Const && (Unary || b.K == Operand::Const))
+                return Operand{Operand::Const, Fold(Op, a.Value, b.Value), 0};
+            int Dst;
+            if (a.K == Operand::Temp)
+            {
+                Dst = a.Index;
+                if (!Unary && b.K == Operand::Temp)
+                    FreeTemps.push_back(b.Index);
+            }
+            else if (!Unary && b.K == Operand::Temp)
+                Dst = b.Index;
+            else
+                Dst = NewTemp();
+            ExprPayoff::Instr I;
+            I.Op = Op;
+            I.Dst = -1 - Dst;
+            I.A = RegOf(a);
+            I.B = Unary ? I.A : RegOf(b);
+            Code.push_back(I);
+            return Operand{Operand::Temp, 0.0, Dst};
+        }
+
+        Operand Expr()
+        {
+            Operand a = Sum();
+            ExprPayoff::OpCode Op;
+            if (Accept("<="))
+                Op = ExprPayoff::OpLe;
+            else if (Accept(">="))
+                Op = ExprPayoff::OpGe;
+            else if (Accept("<"))
+                Op = ExprPayoff::OpLt;
+            else if (Accept(">"))
+                Op = ExprPayoff::OpGt;
+            else
+                return a;
+            Operand b = Sum();
+            return Emit(Op, a, b, false);
+        }
+
+        Operand Sum()
+        {
+            Operand a = Product();
+            while (Error.empty())
+            {
+                if (Accept("+"))
+                    a = Emit(ExprPayoff::OpAdd, a, Product(), false);
+                else if (Accept("-"))
+                    a = Emit(ExprPayoff::OpSub, a, Product(), false);
+                else
+                    break;
+            }
+            return a;
+        }
+
+        Operand Product()
+        {
+            Operand a = Unary();
+            while (Error.empty())
+            {
+                if (Accept("*"))
+                    a = Emit(ExprPayoff::OpMul, a, Unary(), false);
+                else if (Accept("/"))
+                    a = Emit(ExprPayoff::OpDiv, a, Unary(), false);
+                else
+                    break;
+            }
+            return a;
+        }
+
+        Operand Unary()
+        {
+            if (Accept("-"))
+            {
+                Operand a = Unary();
+                return Emit(ExprPayoff::OpNeg, a, a, true);
+            }
+            if (Accept("+"))
+                return Unary();
+            return Primary();
+        }
+
+        Operand Primary()
+        {
+            Operand Zero = {Operand::Const, 0.0, 0};
+            SkipSpace();
+            if (Pos >= Src.size())
+            {
+                Fail("unexpected end of expression");
+                return Zero;
+            }
+            if (Accept("("))
+            {
+                Operand a = Expr();
+                if (!Accept(")"))
+                    Fail("expected )");
+                return a;
+            }
+            char c = Src[Pos];
+            if (isdigit((unsigned char)c) || c == '.')
+            {
+                const char* Start = Src.c_str() + Pos;
+                char* End;
+                double v = strtod(Start, &End);
+                Pos += End - Start;
+                return Operand{Operand::Const, v, 0};
+            }
+            if (!isalpha((unsigned char)c) && c != '_')
+            {
+                Fail(string("unexpected '") + c + "'");
+                return Zero;
+            }
+            size_t Start = Pos;
+            while (Pos < Src.size() && (isalnum((unsigned char)Src[Pos]) || Src[Pos] == '_'))
+                Pos++;
+            string Name = Src.substr(Start, Pos - Start);
+            if (Accept("("))
+                return Call(Name);
+            if (Name == "S")
+                return Operand{Operand::Stock, 0.0, 0};
+            auto It = Params.find(Name);
+            if (It == Params.end())
+            {
+                Fail("unknown parameter " + Name);
+                return Zero;
+            }
+            return Operand{Operand::Const, It->second, 0};
+        }
+
+        Operand Call(const string& Name)
+        {
+            vector<Operand> Args;
+            if (!Accept(")"))
+            {
+                do
+                    Args.push_back(Expr());
+                while (Error.empty() && Accept(","));
+                if (!Accept(")"))
+                    Fail("expected ) after arguments of " + Name);
+            }
+            Operand Zero = {Operand::Const, 0.0, 0};
+            if (!Error.empty())
+                return Zero;
+            if (Name == "max" || Name == "min")
+            {
+                if (Args.size() < 2)
+                {
+                    Fail(Name + " needs at least two arguments");
+                    return Zero;
+                }
+                ExprPayoff::OpCode Op = Name == "max" ? ExprPayoff::OpMax : ExprPayoff::OpMin;
+                Operand a = Args[0];
+                for (size_t k = 1; k < Args.size(); k++)
+                    a = Emit(Op, a, Args[k], false);
+                return a;
+            }
+            if (Name == "abs" || Name == "ind")
+            {
+                if (Args.size() != 1)
+                {
+                    Fail(Name + " takes one argument");
+                    return Zero;
+                }
+                return Emit(Name == "abs" ? ExprPayoff::OpAbs : ExprPayoff::OpInd,
+                            Args[0], Args[0], true);
+            }
+            Fail("unknown function " + Name);
+            return Zero;
+        }
+    };
+}
+
+int ExprPayoff::Compile()
+{
+    Compiler C(Source, Params);
+    Operand Top = C.Expr();
+    if (C.Error.empty() && !C.AtEnd())
+        C.Fail("unexpected trailing input");
+    Code.clear();
+    Consts.clear();
+    NumRegs = 0;
+    Result = -1;
+    if (!C.Error.empty())
+    {
+        Error = C.Error;
+        return 1;
+    }
+    Error.clear();
+    // temporaries go after S and the constants
+    Result = C.RegOf(Top);
+    Consts = C.Consts;
+    int FirstTemp = 1 + Consts.size();
+    for (Instr I : C.Code)
+    {
+        if (I.Dst < 0)
+            I.Dst = FirstTemp - 1 - I.Dst;
+        if (I.A < 0)
+            I.A = FirstTemp - 1 - I.A;
+        if (I.B < 0)
+            I.B = FirstTemp - 1 - I.B;
+        Code.push_back(I);
+    }
+    if (Result < 0)
+        Result = FirstTemp - 1 - Result;
+    NumRegs = FirstTemp + C.GetNumTemps();
+    return 0;
+}
+
+void ExprPayoff::PayoffBatch(const double* z, double* Out, int n)
+{
+    if (Result < 0)
+    {
+        for (int i = 0; i < n; i++)
+            Out[i] = 0.0;
+        return;
+    }
+    thread_local vector<double> Scratch;
+    thread_local vector<double*> Reg;
+    Scratch.resize((size_t)NumRegs * Block);
+    Reg.resize(NumRegs);
+    for (int r = 1; r < NumRegs; r++)
+        Reg[r] = &Scratch[(size_t)r * Block];
+    for (size_t k = 0; k < Consts.size(); k++)
+        for (int i = 0; i < Block; i++)
+            Reg[1 + k][i] = Consts[k];
+
+    for (int b = 0; b < n; b += Block)
+    {
+        int Len = n - b < Block ? n - b : Block;
+        Reg[0] = const_cast<double*>(z + b);
+        for (const Instr& I : Code)
+        {
+            double* d = Reg[I.Dst];
+            const double* a = Reg[I.A];
+            const double* c = Reg[I.B];
+            switch (I.Op)
+            {
+            case OpAdd:
+                for (int i = 0; i < Len; i++) d[i] = a[i] + c[i];
+                break;
+            case OpSub:
+                for (int i = 0; i < Len; i++) d[i] = a[i] - c[i];
+                break;
+            case OpMul:
+                for (int i = 0; i < Len; i++) d[i] = a[i] * c[i];
+                break;
+            case OpDiv:
+                for (int i = 0; i < Len; i++) d[i] = a[i] / c[i];
+                break;
+            case OpMax:
+                for (int i = 0; i < Len; i++) d[i] = a[i] > c[i] ? a[i] : c[i];
+                break;
+            case OpMin:
+                for (int i = 0; i < Len; i++) d[i] = a[i] < c[i] ? a[i] : c[i];
+                break;
+            case OpLt:
+                for (int i = 0; i < Len; i++) d[i] = a[i] < c[i] ? 1.0 : 0.0;
+                break;
+            case OpLe:
+                for (int i = 0; i < Len; i++) d[i] = a[i] <= c[i] ? 1.0 : 0.0;
+                break;
+            case OpGt:
+                for (int i = 0; i < Len; i++) d[i] = a[i] > c[i] ? 1.0 : 0.0;
+                break;
+            case OpGe:
+                for (int i = 0; i < Len; i++) d[i] = a[i] >= c[i] ? 1.0 : 0.0;
+                break;
+            case OpNeg:
+                for (int i = 0; i < Len; i++) d[i] = -a[i];
+                break;
+            case OpAbs:
+                for (int i = 0; i < Len; i++) d[i] = fabs(a[i]);
+                break;
+            case OpInd:
+                for (int i = 0; i < Len; i++) d[i] = a[i] > 0.0 ? 1.0 : 0.0;
+                break;
+            }
+        }
+        const double* Res = Reg[Result];
+        for (int i = 0; i < Len; i++)
+            Out[b + i] = Res[i];
+    }
+}
+
+double ExprPayoff::Payoff(double z)
+{
+    double Out;
+    PayoffBatch(&z, &Out, 1);
+    return Out;
+}
+
+int ExprPayoff::GetInputData()
+{
+    cout << "Enter expression payoff data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter payoff expression in S: ";
+    string Line;
+    getline(cin >> ws, Line);
+    SetExpression(Line);
+    // asking for every parameter the expression names
+    set<string> Names;
+    for (size_t p = 0; p < Line.size();)
+    {
+        if (isalpha((unsigned char)Line[p]) || Line[p] == '_')
+        {
+            size_t q = p;
+            while (q < Line.size() && (isalnum((unsigned char)Line[q]) || Line[q] == '_'))
+                q++;
+            string Name = Line.substr(p, q - p);
+            size_t r = q;
+            while (r < Line.size() && isspace((unsigned char)Line[r]))
+                r++;
+            bool IsCall = r < Line.size() && Line[r] == '(';
+            if (!IsCall && Name != "S" && Names.insert(Name).second)
+            {
+                double v;
+                cout << "Enter " << Name << ": ";
+                cin >> v;
+                SetParam(Name, v);
+            }
+            p = q;
+        }
+        else if (isdigit((unsigned char)Line[p]) || Line[p] == '.')
+        {
+            // skipping numbers so that an exponent like 1e5 is not a name
+            const char* Start = Line.c_str() + p;
+            char* End;
+            strtod(Start, &End);
+            p += End > Start ? End - Start : 1;
+        }
+        else
+            p++;
+    }
+    cout << endl;
+    if (Compile() == 1)
+    {
+        cout << "Invalid payoff expression: " << GetError() << endl;
+        return 1;
+    }
+    return 0;
+}
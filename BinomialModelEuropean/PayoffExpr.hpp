@@ -0,0 +1,55 @@
+#ifndef PayoffExpr_hpp
+#define PayoffExpr_hpp
+#include "OptionsEuropean.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+// Payoff given by an expression in the stock price S, compiled at load
+// time into register bytecode that runs over whole layers, e.g.
+//
+//   max(S - K1, 0) - max(S - K2, 0)
+//   ind(S > K1) * ind(S < K2) * Cash
+//
+// Operators: + - * / and unary -, comparisons < <= > >= giving 1 or 0.
+// Functions: max(a, b, ...), min(a, b, ...), abs(x), ind(x) (1 if x > 0).
+// Any other name is a parameter whose value is set with SetParam().
+class ExprPayoff : public EurOption, public AmOption
+{
+public:
+    enum OpCode
+    {
+        OpAdd, OpSub, OpMul, OpDiv, OpMax, OpMin,
+        OpLt, OpLe, OpGt, OpGe, OpNeg, OpAbs, OpInd
+    };
+    struct Instr
+    {
+        OpCode Op;
+        int Dst;
+        int A;
+        int B; // unused by unary ops
+    };
+private:
+    std::string Source;
+    std::map<std::string, double> Params;
+    std::string Error;
+    // register 0 holds S, registers 1..Consts.size() hold constants,
+    // the rest are temporaries
+    std::vector<double> Consts;
+    std::vector<Instr> Code;
+    int NumRegs;
+    int Result; // register holding the payoff after the last instruction
+public:
+    ExprPayoff() : NumRegs(0), Result(-1) { }
+    void SetExpression(const std::string& Source_) { Source = Source_; }
+    void SetParam(const std::string& Name, double Value) { Params[Name] = Value; }
+    // compiling the expression with the current parameter values,
+    // returns 1 and sets GetError() if it does not parse
+    int Compile();
+    const std::string& GetError() const { return Error; }
+    const std::vector<Instr>& GetCode() const { return Code; }
+    int GetInputData();
+    double Payoff(double z);
+    void PayoffBatch(const double* z, double* Out, int n);
+};
+#endif
@@ -0,0 +1,79 @@
+#include "PayoffFactory.hpp"
+#include "DoubleDigitOpt.hpp"
+#include "Strangle.hpp"
+#include "Butterfly.hpp"
+#include "BullSpread.hpp"
+#include "BearSpread.hpp"
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    const char* Names[] = {"user", "call", "put", "doubdigit", "strangle",
+                           "butterfly", "bullspread", "bearspread"};
+
+    template <class T>
+    Option* MakeTwoStrike(double K1, double K2)
+    {
+        T* Opt = new T;
+        Opt->SetK1(K1);
+        Opt->SetK2(K2);
+        return Opt;
+    }
+}
+
+Option* MakePayoff(PayoffKind Kind, double K1, double K2, int N)
+{
+    Option* Opt = nullptr;
+    switch (Kind)
+    {
+    case CallPayoff:
+    {
+        Call* C = new Call;
+        C->SetK(K1);
+        Opt = C;
+        break;
+    }
+    case PutPayoff:
+    {
+        Put* P = new Put;
+        P->SetK(K1);
+        Opt = P;
+        break;
+    }
+    case DoubDigitPayoff:
+        Opt = MakeTwoStrike<DoubDigitOpt>(K1, K2);
+        break;
+    case StranglePayoff:
+        Opt = MakeTwoStrike<Strangle>(K1, K2);
+        break;
+    case ButterflyPayoff:
+        Opt = MakeTwoStrike<Butterfly>(K1, K2);
+        break;
+    case BullSpreadPayoff:
+        Opt = MakeTwoStrike<BullSpread>(K1, K2);
+        break;
+    case BearSpreadPayoff:
+        Opt = MakeTwoStrike<BearSpread>(K1, K2);
+        break;
+    default:
+        return nullptr;
+    }
+    Opt->SetN(N);
+    return Opt;
+}
+
+const char* PayoffName(PayoffKind Kind)
+{
+    if (Kind < UserPayoff || Kind > BearSpreadPayoff)
+        return Names[0];
+    return Names[Kind];
+}
+
+PayoffKind PayoffFromName(const char* Name)
+{
+    for (int k = CallPayoff; k <= BearSpreadPayoff; k++)
+        if (strcmp(Name, Names[k]) == 0)
+            return (PayoffKind)k;
+    return UserPayoff;
+}
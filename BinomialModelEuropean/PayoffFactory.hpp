@@ -0,0 +1,11 @@
+#ifndef PayoffFactory_hpp
+#define PayoffFactory_hpp
+#include "OptionsEuropean.hpp"
+// creating a payoff object of the given class, K2 is ignored for
+// single-strike payoffs; returns nullptr for UserPayoff
+Option* MakePayoff(PayoffKind Kind, double K1, double K2, int N);
+// short lower-case name of a payoff class, e.g. "bullspread"
+const char* PayoffName(PayoffKind Kind);
+// payoff class of a name returned by PayoffName, UserPayoff if unknown
+PayoffKind PayoffFromName(const char* Name);
+#endif
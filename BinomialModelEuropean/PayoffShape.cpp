@@ -0,0 +1,66 @@
+#include "PayoffShape.hpp"
+using namespace std;
+
+int GetPayoffShape(Option& Opt, PayoffShape& Shape)
+{
+    double K1, K2;
+    Opt.GetStrikes(K1, K2);
+    Shape.Breaks.clear();
+    switch (Opt.GetKind())
+    {
+    case CallPayoff:
+    case PutPayoff:
+        Shape.Breaks.push_back(K1);
+        break;
+    case ButterflyPayoff:
+        Shape.Breaks.push_back(K1);
+        Shape.Breaks.push_back((K1 + K2) / 2.0);
+        Shape.Breaks.push_back(K2);
+        break;
+    case DoubDigitPayoff:
+    case StranglePayoff:
+    case BullSpreadPayoff:
+    case BearSpreadPayoff:
+        Shape.Breaks.push_back(K1);
+        Shape.Breaks.push_back(K2);
+        break;
+    default:
+        return 1;
+    }
+    // every piece is linear, so two payoff values inside it fix A and B
+    int Pieces = Shape.Breaks.size() + 1;
+    Shape.A.assign(Pieces, 0.0);
+    Shape.B.assign(Pieces, 0.0);
+    for (int j = 0; j < Pieces; j++)
+    {
+        double z1, z2;
+        if (j == 0)
+        {
+            z1 = Shape.Breaks[0] * 0.25;
+            z2 = Shape.Breaks[0] * 0.5;
+        }
+        else if (j == Pieces - 1)
+        {
+            z1 = Shape.Breaks[j - 1] * 2.0;
+            z2 = Shape.Breaks[j - 1] * 3.0;
+        }
+        else
+        {
+            double Lo = Shape.Breaks[j - 1], Hi = Shape.Breaks[j];
+            z1 = Lo + (Hi - Lo) / 3.0;
+            z2 = Lo + 2.0 * (Hi - Lo) / 3.0;
+        }
+        double f1 = Opt.Payoff(z1), f2 = Opt.Payoff(z2);
+        Shape.B[j] = (f2 - f1) / (z2 - z1);
+        Shape.A[j] = f1 - Shape.B[j] * z1;
+    }
+    return 0;
+}
+
+int PieceOf(const PayoffShape& Shape, double z)
+{
+    int j = 0;
+    while (j < (int)Shape.Breaks.size() && z > Shape.Breaks[j])
+        j++;
+    return j;
+}
@@ -0,0 +1,21 @@
+#ifndef PayoffShape_hpp
+#define PayoffShape_hpp
+#include "OptionsEuropean.hpp"
+#include <vector>
+// A library payoff as linear pieces A[j] + B[j] z. Piece j lies between
+// Breaks[j-1] and Breaks[j], the first piece is unbounded below and the
+// last unbounded above. Breaks are the strikes and the points where the
+// payoff jumps, so a node whose reachable leaves all lie strictly inside
+// one piece has the exact value A[j] (1+R)^-(N-n) + B[j] S(n,i).
+struct PayoffShape
+{
+    std::vector<double> Breaks;
+    std::vector<double> A;
+    std::vector<double> B;
+};
+// shape of a library payoff from its class and strikes, returns 1 for
+// user payoffs
+int GetPayoffShape(Option& Opt, PayoffShape& Shape);
+// piece containing z, ties going to the lower piece
+int PieceOf(const PayoffShape& Shape, double z);
+#endif
@@ -0,0 +1,155 @@
+#include "PricingEngines.hpp"
+#include "SnapshotCache.hpp"
+#include "TruncatedLattice.hpp"
+#include "AmericanFastPath.hpp"
+#include "AdaptiveLattice.hpp"
+#include "FloatLattice.hpp"
+using namespace std;
+
+namespace
+{
+    // nodes of the whole triangle up to the contract's N
+    long long Triangle(EngineContract& C, BinModel& Model)
+    {
+        long long N = C.Opt->GetN();
+        return (N + 1) * (N + 2) / 2;
+    }
+
+    long long Unknown(EngineContract& C, BinModel& Model)
+    {
+        return -1;
+    }
+
+    double PriceCRR(EngineContract& C, BinModel& Model)
+    {
+        return C.Eur->PriceByCRR(Model);
+    }
+
+    double PriceSnell(EngineContract& C, BinModel& Model)
+    {
+        return C.Am->PriceBySnell(Model);
+    }
+
+    double PriceSnapshotEur(EngineContract& C, BinModel& Model)
+    {
+        Snapshot Snap;
+        ComputeSnapshot(*C.Opt, Model, false, false, Snap);
+        return Snap.Price;
+    }
+
+    double PriceSnapshotAm(EngineContract& C, BinModel& Model)
+    {
+        Snapshot Snap;
+        ComputeSnapshot(*C.Opt, Model, true, false, Snap);
+        return Snap.Price;
+    }
+
+    double PriceTruncatedEur(EngineContract& C, BinModel& Model)
+    {
+        TruncatedLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, false);
+    }
+
+    double PriceTruncatedAm(EngineContract& C, BinModel& Model)
+    {
+        TruncatedLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, true);
+    }
+
+    long long NodesTruncatedEur(EngineContract& C, BinModel& Model)
+    {
+        TruncatedLattice Lattice;
+        Lattice.Price(*C.Opt, Model, false);
+        return Lattice.GetNodes();
+    }
+
+    long long NodesTruncatedAm(EngineContract& C, BinModel& Model)
+    {
+        TruncatedLattice Lattice;
+        Lattice.Price(*C.Opt, Model, true);
+        return Lattice.GetNodes();
+    }
+
+    double PriceFastPath(EngineContract& C, BinModel& Model)
+    {
+        AmericanFastPath Fast;
+        return Fast.Price(*C.Opt, Model);
+    }
+
+    double PriceAdaptiveEur(EngineContract& C, BinModel& Model)
+    {
+        AdaptiveLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, false);
+    }
+
+    double PriceAdaptiveAm(EngineContract& C, BinModel& Model)
+    {
+        AdaptiveLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, true);
+    }
+
+    long long NodesAdaptiveEur(EngineContract& C, BinModel& Model)
+    {
+        AdaptiveLattice Lattice;
+        Lattice.Price(*C.Opt, Model, false);
+        return Lattice.GetNodes();
+    }
+
+    long long NodesAdaptiveAm(EngineContract& C, BinModel& Model)
+    {
+        AdaptiveLattice Lattice;
+        Lattice.Price(*C.Opt, Model, true);
+        return Lattice.GetNodes();
+    }
+
+    double PriceFloatEur(EngineContract& C, BinModel& Model)
+    {
+        FloatLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, false);
+    }
+
+    double PriceFloatAm(EngineContract& C, BinModel& Model)
+    {
+        FloatLattice Lattice;
+        return Lattice.Price(*C.Opt, Model, true);
+    }
+
+    // a price that fell back to double layers moved other bytes per node
+    long long NodesFloatEur(EngineContract& C, BinModel& Model)
+    {
+        FloatLattice Lattice;
+        Lattice.Price(*C.Opt, Model, false);
+        return Lattice.GetFellBack() ? -1 : Triangle(C, Model);
+    }
+
+    long long NodesFloatAm(EngineContract& C, BinModel& Model)
+    {
+        FloatLattice Lattice;
+        Lattice.Price(*C.Opt, Model, true);
+        return Lattice.GetFellBack() ? -1 : Triangle(C, Model);
+    }
+}
+
+EngineContract MakeEngineContract(Option* Opt)
+{
+    EngineContract C = {Opt, dynamic_cast<EurOption*>(Opt), dynamic_cast<AmOption*>(Opt)};
+    return C;
+}
+
+// a European step reads two values and writes one; an American step also
+// writes and reads back the stock price and the exercise value
+const PricingEngine Engines[] = {
+    {"crr", false, PriceCRR, Triangle, 24},
+    {"snell", true, PriceSnell, Triangle, 56},
+    {"snapshot", false, PriceSnapshotEur, Triangle, 24},
+    {"snapshot", true, PriceSnapshotAm, Triangle, 56},
+    {"truncated", false, PriceTruncatedEur, NodesTruncatedEur, 24},
+    {"truncated", true, PriceTruncatedAm, NodesTruncatedAm, 56},
+    {"fastpath", true, PriceFastPath, Unknown, 0},
+    {"adaptive", false, PriceAdaptiveEur, NodesAdaptiveEur, 24},
+    {"adaptive", true, PriceAdaptiveAm, NodesAdaptiveAm, 56},
+    {"float", false, PriceFloatEur, NodesFloatEur, 12},
+    {"float", true, PriceFloatAm, NodesFloatAm, 12},
+};
+
+const int NumEngines = sizeof(Engines) / sizeof(Engines[0]);
@@ -0,0 +1,28 @@
+#ifndef PricingEngines_hpp
+#define PricingEngines_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+// a contract seen through every interface an engine may need
+struct EngineContract
+{
+    Option* Opt;
+    EurOption* Eur;
+    AmOption* Am;
+};
+EngineContract MakeEngineContract(Option* Opt);
+
+// one pricing engine for one exercise style, as swept by MainBenchmark
+// and MainConvergence
+struct PricingEngine
+{
+    const char* Name;
+    bool American;
+    double (*Price)(EngineContract& C, BinModel& Model);
+    // lattice nodes one call visits, -1 if the engine cannot tell
+    long long (*Nodes)(EngineContract& C, BinModel& Model);
+    // bytes the induction moves per node
+    int NodeBytes;
+};
+extern const PricingEngine Engines[];
+extern const int NumEngines;
+#endif
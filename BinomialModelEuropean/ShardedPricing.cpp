@@ -0,0 +1,334 @@
+#include "ShardedPricing.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#ifndef _WIN32
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace
+{
+    // rounding a byte count up to a whole number of pages
+    size_t PageAlign(size_t Bytes, size_t Page)
+    {
+        return (Bytes + Page - 1) / Page * Page;
+    }
+
+    // parsing a sysfs cpu list such as "0-3,8-11"
+    vector<int> ParseCpuList(const string& List)
+    {
+        vector<int> Cpus;
+        stringstream ss(List);
+        string Range;
+        while (getline(ss, Range, ','))
+        {
+            if (Range.empty())
+                continue;
+            size_t Dash = Range.find('-');
+            int Lo = stoi(Range.substr(0, Dash));
+            int Hi = Dash == string::npos ? Lo : stoi(Range.substr(Dash + 1));
+            for (int c = Lo; c <= Hi; c++)
+                Cpus.push_back(c);
+        }
+        return Cpus;
+    }
+
+    // cores of every NUMA node, a single node holding all cores if the
+    // topology cannot be read
+    vector<vector<int>> NodeCpus()
+    {
+        vector<vector<int>> Nodes;
+        for (int k = 0;; k++)
+        {
+            ifstream in("/sys/devices/system/node/node" + to_string(k) + "/cpulist");
+            string List;
+            if (!in || !getline(in, List))
+                break;
+            vector<int> Cpus = ParseCpuList(List);
+            if (!Cpus.empty())
+                Nodes.push_back(Cpus);
+        }
+        if (Nodes.empty())
+        {
+            vector<int> All;
+#ifndef _WIN32
+            long Count = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+            long Count = 1;
+#endif
+            for (int c = 0; c < Count; c++)
+                All.push_back(c);
+            Nodes.push_back(All);
+        }
+        return Nodes;
+    }
+
+    // layout of the shared segment: the shard table on its own pages, then
+    // one page-aligned block per shard holding Price[] followed by Done[]
+    struct SegmentLayout
+    {
+        size_t TableBytes;
+        vector<size_t> BlockOffset;
+        size_t TotalBytes;
+    };
+
+    SegmentLayout MakeLayout(const vector<ShardInfo>& Info, size_t Page)
+    {
+        SegmentLayout L;
+        L.TableBytes = PageAlign(Info.size() * sizeof(ShardInfo), Page);
+        size_t Offset = L.TableBytes;
+        for (size_t s = 0; s < Info.size(); s++)
+        {
+            size_t Len = Info[s].Last - Info[s].First;
+            L.BlockOffset.push_back(Offset);
+            Offset += PageAlign(Len * (sizeof(double) + 1) + 1, Page);
+        }
+        L.TotalBytes = Offset;
+        return L;
+    }
+
+    // pricing one slice, skipping contracts already marked done
+    void RunShard(vector<EurOption*>& Book, BinModel& Model, ShardInfo* Table,
+                  int s, char* Block)
+    {
+        ShardInfo& Sh = Table[s];
+        int Len = Sh.Last - Sh.First;
+        double* Price = (double*)Block;
+        char* Done = Block + Len * sizeof(double);
+        auto Start = chrono::steady_clock::now();
+        int Priced = 0;
+        for (int k = 0; k < Len; k++)
+        {
+            if (Done[k])
+                continue;
+            Price[k] = Book[Sh.First + k]->PriceByCRR(Model);
+            // the price must be visible before the flag that publishes it
+            atomic_thread_fence(memory_order_release);
+            Done[k] = 1;
+            Priced++;
+        }
+        auto End = chrono::steady_clock::now();
+        Sh.Priced = Priced;
+        Sh.Millis = chrono::duration<double, milli>(End - Start).count();
+        atomic_thread_fence(memory_order_release);
+        Sh.Status = ShardDone;
+    }
+
+#ifndef _WIN32
+    // restricting the calling process to the cores of one node, each shard
+    // on a node getting its own share of the node's cores where possible;
+    // returns the node, or -1 if the process could not be pinned
+    int PinShard(const vector<vector<int>>& Nodes, int s, int NumShards)
+    {
+        int NumNodes = Nodes.size();
+        int Node = s % NumNodes;
+        const vector<int>& Cpus = Nodes[Node];
+        int OnNode = (NumShards - Node + NumNodes - 1) / NumNodes;
+        int Rank = s / NumNodes;
+        int Share = Cpus.size() / OnNode;
+#ifdef __linux__
+        cpu_set_t Set;
+        CPU_ZERO(&Set);
+        if (Share >= 1)
+            for (int c = Rank * Share; c < (Rank + 1) * Share; c++)
+                CPU_SET(Cpus[c], &Set);
+        else
+            for (int c : Cpus)
+                CPU_SET(c, &Set);
+        return sched_setaffinity(0, sizeof(Set), &Set) == 0 ? Node : -1;
+#else
+        (void)Share;
+        (void)Rank;
+        return -1;
+#endif
+    }
+
+    pid_t StartShard(vector<EurOption*>& Book, BinModel& Model, ShardInfo* Table,
+                     int s, char* Block, const vector<vector<int>>& Nodes,
+                     int NumShards, bool Pin)
+    {
+        Table[s].Status = ShardRunning;
+        pid_t Pid = fork();
+        if (Pid == 0)
+        {
+            // the table is shared, so the report shows where it really ran
+            if (Pin)
+                Table[s].Node = PinShard(Nodes, s, NumShards);
+            RunShard(Book, Model, Table, s, Block);
+            _exit(0);
+        }
+        return Pid;
+    }
+#endif
+}
+
+int ShardedPricer::PriceBook(vector<EurOption*>& Book, BinModel Model,
+                             vector<double>& Prices)
+{
+    int Count = Book.size();
+    int Shards = NumShards < 1 ? 1 : NumShards;
+    if (Shards > Count)
+        Shards = Count > 0 ? Count : 1;
+    vector<vector<int>> Nodes = NodeCpus();
+
+    // contiguous slices of nearly equal length
+    Info.assign(Shards, ShardInfo());
+    for (int s = 0; s < Shards; s++)
+    {
+        Info[s].Status = ShardPending;
+        Info[s].First = (long long)Count * s / Shards;
+        Info[s].Last = (long long)Count * (s + 1) / Shards;
+        Info[s].Node = Pin ? s % (int)Nodes.size() : -1;
+        Info[s].Restarts = 0;
+        Info[s].Priced = 0;
+        Info[s].Millis = 0.0;
+    }
+    Prices.assign(Count, 0.0);
+
+#ifdef _WIN32
+    // no fork(): pricing every slice in this process
+    vector<char> Block;
+    for (int s = 0; s < Shards; s++)
+    {
+        int Len = Info[s].Last - Info[s].First;
+        Block.assign(Len * (sizeof(double) + 1) + 1, 0);
+        RunShard(Book, Model, Info.data(), s, Block.data());
+        for (int k = 0; k < Len; k++)
+            Prices[Info[s].First + k] = ((double*)Block.data())[k];
+    }
+    return 0;
+#else
+    size_t Page = sysconf(_SC_PAGESIZE);
+    SegmentLayout L = MakeLayout(Info, Page);
+    void* Seg = mmap(nullptr, L.TotalBytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (Seg == MAP_FAILED)
+    {
+        cout << "Could not map shared result segment" << endl;
+        return 1;
+    }
+    // only the shard table is touched here, the result blocks are first
+    // touched by their workers and so land on the workers' nodes
+    ShardInfo* Table = (ShardInfo*)Seg;
+    for (int s = 0; s < Shards; s++)
+        Table[s] = Info[s];
+    char* Base = (char*)Seg;
+
+    // starting a worker for shard s; a failed fork counts as a crash, and
+    // once the restarts are used up the shard is failed and has no worker.
+    // fork() fails when the process table or memory is short, so the next
+    // attempt waits 1 ms, doubling up to 64 ms
+    vector<pid_t> Pid(Shards, -1);
+    auto Launch = [&](int s)
+    {
+        for (int Attempt = 0;; Attempt++)
+        {
+            Pid[s] = StartShard(Book, Model, Table, s, Base + L.BlockOffset[s],
+                                Nodes, Shards, Pin);
+            if (Pid[s] > 0)
+                return;
+            if (Table[s].Restarts >= MaxRestarts)
+            {
+                Table[s].Status = ShardFailed;
+                return;
+            }
+            Table[s].Restarts++;
+            usleep(1000u << min(Attempt, 6));
+        }
+    };
+    for (int s = 0; s < Shards; s++)
+        Launch(s);
+
+    // only our own workers are waited for, so children the caller has
+    // forked itself are left alone
+    for (;;)
+    {
+        int Running = 0;
+        bool Reaped = false;
+        for (int s = 0; s < Shards; s++)
+        {
+            if (Pid[s] <= 0)
+                continue;
+            int WaitStatus = 0;
+            pid_t Done = waitpid(Pid[s], &WaitStatus, WNOHANG);
+            if (Done == 0 || (Done < 0 && errno == EINTR))
+            {
+                Running++;
+                continue;
+            }
+            Reaped = true;
+            Pid[s] = -1;
+            atomic_thread_fence(memory_order_acquire);
+            // a worker reaped by someone else (ECHILD) has no exit status,
+            // its shard table entry alone tells whether it finished
+            bool Exited = Done < 0 || (WIFEXITED(WaitStatus) && WEXITSTATUS(WaitStatus) == 0);
+            if (Exited && Table[s].Status == ShardDone)
+                continue;
+            if (Table[s].Restarts < MaxRestarts)
+            {
+                // completed contracts keep their Done flag and are not redone
+                Table[s].Restarts++;
+                Launch(s);
+                if (Pid[s] > 0)
+                    Running++;
+                continue;
+            }
+            Table[s].Status = ShardFailed;
+        }
+        if (Running == 0)
+            break;
+        if (!Reaped)
+            usleep(1000);
+    }
+
+    // gathering results, contracts of failed shards that never completed
+    // are left at 0.0
+    for (int s = 0; s < Shards; s++)
+    {
+        Info[s] = Table[s];
+        int Len = Info[s].Last - Info[s].First;
+        double* Price = (double*)(Base + L.BlockOffset[s]);
+        char* DoneFlag = (char*)(Price + Len);
+        for (int k = 0; k < Len; k++)
+            if (DoneFlag[k])
+                Prices[Info[s].First + k] = Price[k];
+    }
+    munmap(Seg, L.TotalBytes);
+    for (int s = 0; s < Shards; s++)
+        if (Info[s].Status != ShardDone)
+            return 1;
+    return 0;
+#endif
+}
+
+void ShardedPricer::PrintReport()
+{
+    const char* Names[] = {"pending", "running", "done", "failed"};
+    double Slowest = 0.0;
+    for (const ShardInfo& Sh : Info)
+    {
+        cout << "shard " << setw(3) << &Sh - Info.data()
+             << "  contracts " << Sh.First << "-" << Sh.Last - 1
+             << "  node " << Sh.Node
+             << "  " << Names[Sh.Status]
+             << "  priced " << Sh.Priced
+             << "  restarts " << Sh.Restarts
+             << "  " << fixed << setprecision(2) << Sh.Millis << " ms"
+             << defaultfloat << endl;
+        if (Sh.Millis > Slowest)
+            Slowest = Sh.Millis;
+    }
+    cout << "slowest shard: " << fixed << setprecision(2) << Slowest << " ms"
+         << defaultfloat << endl;
+}
@@ -0,0 +1,53 @@
+#ifndef ShardedPricing_hpp
+#define ShardedPricing_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+// state of one shard in the shared result segment
+enum ShardStatus
+{
+    ShardPending = 0,
+    ShardRunning = 1,
+    ShardDone = 2,
+    ShardFailed = 3
+};
+
+struct ShardInfo
+{
+    int Status;
+    int First;     // first contract of the slice
+    int Last;      // one past the last contract of the slice
+    int Node;      // NUMA node the worker was pinned to, -1 if not pinned
+    int Restarts;  // how many times the shard was restarted after a crash
+    int Priced;    // contracts priced by the last run (skipped ones excluded)
+    double Millis; // wall time of the last run of the shard
+};
+
+// Prices a book of European options in NumShards forked worker processes.
+// Each worker is pinned to the cores of one NUMA node, prices a contiguous
+// slice of the book and writes straight into a shared memory segment; the
+// coordinator copies the finished prices out of it once, after every shard
+// has ended. A worker that dies, or cannot be forked, is restarted and
+// skips the contracts its previous run already completed.
+class ShardedPricer
+{
+private:
+    int NumShards;
+    int MaxRestarts;
+    bool Pin;
+    std::vector<ShardInfo> Info; // shard table of the last run
+public:
+    ShardedPricer() : NumShards(1), MaxRestarts(2), Pin(true) { }
+    void SetNumShards(int NumShards_) { NumShards = NumShards_; }
+    void SetMaxRestarts(int MaxRestarts_) { MaxRestarts = MaxRestarts_; }
+    void SetPinning(bool Pin_) { Pin = Pin_; }
+    // pricing Book[k] into Prices[k], returns 0 if every shard completed,
+    // 1 otherwise with the unfinished contracts left at 0.0
+    int PriceBook(std::vector<EurOption*>& Book, BinModel Model,
+                  std::vector<double>& Prices);
+    const std::vector<ShardInfo>& GetShardInfo() const { return Info; }
+    // displaying status and timing of every shard
+    void PrintReport();
+};
+#endif
@@ -0,0 +1,324 @@
+#include "SnapshotCache.hpp"
+#include "Instrumentation.hpp"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <filesystem>
+#include <atomic>
+#include <string>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+using namespace std;
+
+namespace
+{
+    const char SnapshotMagic[8] = {'B', 'M', 'S', 'N', 'A', 'P', '0', '1'};
+
+    // fixed-size part of a snapshot file, followed by BoundaryLen ints of
+    // ExerciseLo and BoundaryLen ints of ExerciseHi
+    struct SnapshotHeader
+    {
+        char Magic[8];
+        SnapshotKey Key;
+        double Price;
+        double Delta;
+        double Gamma;
+        double Theta;
+        int BoundaryLen;
+        int Pad;
+    };
+
+    // reading a snapshot out of a loaded file image, returns 1 if the image
+    // is not a complete snapshot for Key
+    int ParseSnapshot(const char* Data, size_t Size, const SnapshotKey& Key,
+                      Snapshot& Snap)
+    {
+        if (Size < sizeof(SnapshotHeader))
+            return 1;
+        SnapshotHeader H;
+        memcpy(&H, Data, sizeof(H));
+        if (memcmp(H.Magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 ||
+            memcmp(&H.Key, &Key, sizeof(SnapshotKey)) != 0 || H.BoundaryLen < 0 ||
+            Size != sizeof(H) + 2 * sizeof(int) * (size_t)H.BoundaryLen)
+            return 1;
+        Snap.Price = H.Price;
+        Snap.Delta = H.Delta;
+        Snap.Gamma = H.Gamma;
+        Snap.Theta = H.Theta;
+        const int* Lo = (const int*)(Data + sizeof(H));
+        Snap.ExerciseLo.assign(Lo, Lo + H.BoundaryLen);
+        Snap.ExerciseHi.assign(Lo + H.BoundaryLen, Lo + 2 * H.BoundaryLen);
+        return 0;
+    }
+
+    int GetPid()
+    {
+#ifndef _WIN32
+        return getpid();
+#else
+        return _getpid();
+#endif
+    }
+}
+
+int MakeSnapshotKey(Option& Opt, BinModel Model, bool American,
+                    bool WithBoundary, SnapshotKey& Key)
+{
+    memset(&Key, 0, sizeof(Key));
+    if (Opt.GetKind() == UserPayoff)
+        return 1;
+    Key.S0 = Model.GetS0();
+    Key.U = Model.GetU();
+    Key.D = Model.GetD();
+    Key.R = Model.GetR();
+    Opt.GetStrikes(Key.K1, Key.K2);
+    Key.Kind = Opt.GetKind();
+    Key.N = Opt.GetN();
+    Key.American = American ? 1 : 0;
+    Key.WithBoundary = American && WithBoundary ? 1 : 0;
+    Key.EngineVersion = LatticeEngineVersion;
+    // FNV-1a over the dividend schedule, in the order it was given
+    if (Model.HasDividends())
+    {
+        unsigned long long h = 14695981039346656037ULL;
+        for (const Dividend& d : Model.GetDividends())
+        {
+            double Fields[3] = {(double)d.n, d.Amount, d.Proportional ? 1.0 : 0.0};
+            const unsigned char* p = (const unsigned char*)Fields;
+            for (size_t k = 0; k < sizeof(Fields); k++)
+            {
+                h ^= p[k];
+                h *= 1099511628211ULL;
+            }
+        }
+        Key.Dividends = h;
+    }
+    return 0;
+}
+
+unsigned long long HashSnapshotKey(const SnapshotKey& Key)
+{
+    const unsigned char* p = (const unsigned char*)&Key;
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t k = 0; k < sizeof(Key); k++)
+    {
+        h ^= p[k];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void ComputeSnapshot(Option& Opt, BinModel Model, bool American,
+                     bool WithBoundary, Snapshot& Snap)
+{
+    double q = Model.RiskNeutProb();
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    int N = Opt.GetN();
+    bool Boundary = American && WithBoundary;
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    vector<double> ExVal(American ? N + 1 : 0);
+    vector<char> Exercised(Boundary ? N + 1 : 0);
+    double Layer1[2] = {0.0, 0.0};
+    double Layer2[3] = {0.0, 0.0, 0.0};
+    Snap.ExerciseLo.assign(Boundary ? N + 1 : 0, 0);
+    Snap.ExerciseHi.assign(Boundary ? N + 1 : 0, 0);
+    INSTR_COUNT(Allocations, 2 + (American ? 1 : 0) + (Boundary ? 1 : 0));
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        Opt.PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N; n >= 0; n--)
+        {
+            if (n < N)
+            {
+                if (American)
+                {
+                    Model.SLayer(n, Stock.data());
+                    Opt.PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+                }
+                for (int i = 0; i <= n; i++)
+                {
+                    double ContVal = Up * Price[i + 1] + Down * Price[i];
+                    if (American)
+                    {
+                        if (Boundary)
+                            Exercised[i] = ExVal[i] > ContVal && ExVal[i] > 0.0;
+                        Price[i] = max(ExVal[i], ContVal);
+                    }
+                    else
+                        Price[i] = ContVal;
+                }
+            }
+            else if (Boundary)
+            {
+                for (int i = 0; i <= N; i++)
+                    Exercised[i] = Price[i] > 0.0;
+            }
+            if (Boundary)
+            {
+                int Lo = 0;
+                while (Lo <= n && Exercised[Lo])
+                    Lo++;
+                int Hi = 0;
+                while (Hi <= n && Exercised[n - Hi])
+                    Hi++;
+                Snap.ExerciseLo[n] = Lo;
+                Snap.ExerciseHi[n] = Hi;
+            }
+            if (n == 2)
+                for (int i = 0; i <= 2; i++)
+                    Layer2[i] = Price[i];
+            if (n == 1)
+                for (int i = 0; i <= 1; i++)
+                    Layer1[i] = Price[i];
+        }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+        if (American)
+            INSTR_COUNT(PayoffEvals, (unsigned long long)N * (N + 1) / 2);
+    }
+    Snap.Price = Price[0];
+    Snap.Delta = 0.0;
+    Snap.Gamma = 0.0;
+    Snap.Theta = 0.0;
+    INSTR_PHASE(GreeksPhase);
+    if (N >= 1)
+        Snap.Delta = (Layer1[1] - Layer1[0]) / (Model.S(1, 1) - Model.S(1, 0));
+    if (N >= 2)
+    {
+        double DeltaUp = (Layer2[2] - Layer2[1]) / (Model.S(2, 2) - Model.S(2, 1));
+        double DeltaDown = (Layer2[1] - Layer2[0]) / (Model.S(2, 1) - Model.S(2, 0));
+        Snap.Gamma = (DeltaUp - DeltaDown) / ((Model.S(2, 2) - Model.S(2, 0)) / 2.0);
+        Snap.Theta = (Layer2[1] - Snap.Price) / 2.0;
+    }
+}
+
+string SnapshotCache::PathOf(const SnapshotKey& Key)
+{
+    char Name[32];
+    snprintf(Name, sizeof(Name), "%016llx.snap", HashSnapshotKey(Key));
+    return Dir + "/" + Name;
+}
+
+int SnapshotCache::Lookup(const SnapshotKey& Key, Snapshot& Snap)
+{
+    string Path = PathOf(Key);
+    int Result = 1;
+#ifndef _WIN32
+    int fd = open(Path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* Data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (Data != MAP_FAILED)
+            {
+                Result = ParseSnapshot((const char*)Data, st.st_size, Key, Snap);
+                munmap(Data, st.st_size);
+            }
+        }
+        close(fd);
+    }
+#else
+    ifstream in(Path, ios::binary);
+    if (in)
+    {
+        vector<char> Data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        Result = ParseSnapshot(Data.data(), Data.size(), Key, Snap);
+    }
+#endif
+    if (Result == 0)
+    {
+        Hits++;
+        return 0;
+    }
+    // a file under this name that does not hold Key may be another live
+    // contract whose key hashes the same, so it is left alone; Store()
+    // replaces it and Prune() removes it once it is stale
+    Misses++;
+    return 1;
+}
+
+int SnapshotCache::Store(const SnapshotKey& Key, const Snapshot& Snap)
+{
+    error_code ec;
+    filesystem::create_directories(Dir, ec);
+    SnapshotHeader H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.Magic, SnapshotMagic, sizeof(SnapshotMagic));
+    H.Key = Key;
+    H.Price = Snap.Price;
+    H.Delta = Snap.Delta;
+    H.Gamma = Snap.Gamma;
+    H.Theta = Snap.Theta;
+    H.BoundaryLen = Snap.ExerciseLo.size();
+    string Path = PathOf(Key);
+    // a name of its own for every writer, so that two processes storing the
+    // same key cannot interleave their bytes in one temporary file
+    static atomic<unsigned> Serial(0);
+    string Tmp = Path + "." + to_string(GetPid()) + "-" + to_string(Serial++) + ".tmp";
+    {
+        ofstream out(Tmp, ios::binary | ios::trunc);
+        if (!out)
+            return 1;
+        out.write((const char*)&H, sizeof(H));
+        out.write((const char*)Snap.ExerciseLo.data(), sizeof(int) * H.BoundaryLen);
+        out.write((const char*)Snap.ExerciseHi.data(), sizeof(int) * H.BoundaryLen);
+        if (!out)
+            return 1;
+    }
+    // readers never see a partly written file
+    filesystem::rename(Tmp, Path, ec);
+    return ec ? 1 : 0;
+}
+
+void SnapshotCache::Price(Option& Opt, BinModel Model, bool American,
+                          bool WithBoundary, Snapshot& Snap)
+{
+    SnapshotKey Key;
+    if (MakeSnapshotKey(Opt, Model, American, WithBoundary, Key) == 1)
+    {
+        ComputeSnapshot(Opt, Model, American, WithBoundary, Snap);
+        return;
+    }
+    if (Lookup(Key, Snap) == 0)
+        return;
+    ComputeSnapshot(Opt, Model, American, WithBoundary, Snap);
+    if (Store(Key, Snap) == 1)
+        cout << "Could not store snapshot " << PathOf(Key) << endl;
+}
+
+int SnapshotCache::Prune(const vector<SnapshotKey>& Live)
+{
+    set<string> Keep;
+    for (const SnapshotKey& Key : Live)
+        Keep.insert(filesystem::path(PathOf(Key)).filename().string());
+    int Removed = 0;
+    error_code ec;
+    for (const auto& Entry : filesystem::directory_iterator(Dir, ec))
+    {
+        string Name = Entry.path().filename().string();
+        bool Snap = Entry.path().extension() == ".snap" ||
+                    Entry.path().extension() == ".tmp";
+        if (Snap && Keep.count(Name) == 0)
+        {
+            filesystem::remove(Entry.path(), ec);
+            Removed++;
+        }
+    }
+    Invalidated += Removed;
+    return Removed;
+}
@@ -0,0 +1,81 @@
+#ifndef SnapshotCache_hpp
+#define SnapshotCache_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <string>
+#include <vector>
+
+// version of the lattice numerics, stored snapshots computed by another
+// version never match and are removed by Prune()
+const int LatticeEngineVersion = 4;
+
+// everything a snapshot depends on; the cache file name is a hash of it
+struct SnapshotKey
+{
+    double S0;
+    double U;
+    double D;
+    double R;
+    double K1;
+    double K2;
+    int Kind;
+    int N;
+    int American;
+    int WithBoundary;
+    int EngineVersion;
+    int Pad; // keeps the struct free of uninitialised padding bytes
+    unsigned long long Dividends; // hash of the dividend schedule, 0 without
+};
+
+struct Snapshot
+{
+    double Price;
+    double Delta; // at the root, from layer 1
+    double Gamma; // at the root, from layer 2
+    double Theta; // per step, from layer 2
+    // American only: at step n the nodes 0..ExerciseLo[n]-1 and
+    // n-ExerciseHi[n]+1..n are exercised (regions touching the layer ends)
+    std::vector<int> ExerciseLo;
+    std::vector<int> ExerciseHi;
+};
+
+// key of a contract, returns 1 for user payoffs which cannot be identified
+int MakeSnapshotKey(Option& Opt, BinModel Model, bool American,
+                    bool WithBoundary, SnapshotKey& Key);
+// 64 bit FNV-1a hash of the key
+unsigned long long HashSnapshotKey(const SnapshotKey& Key);
+// pricing by backward induction, keeping layers 1 and 2 for the Greeks
+void ComputeSnapshot(Option& Opt, BinModel Model, bool American,
+                     bool WithBoundary, Snapshot& Snap);
+
+// Content-addressed store of snapshots, one file per key in a directory.
+// Files are memory-mapped on load and checked against the full key, so a
+// contract whose model or terms changed simply misses and is recomputed.
+// A file that fails the check is kept until Store() or Prune() replaces
+// or removes it.
+class SnapshotCache
+{
+private:
+    std::string Dir;
+    int Hits;
+    int Misses;
+    int Invalidated;
+    std::string PathOf(const SnapshotKey& Key);
+public:
+    SnapshotCache() : Dir("snapshots"), Hits(0), Misses(0), Invalidated(0) { }
+    void SetDirectory(const std::string& Dir_) { Dir = Dir_; }
+    // loading a stored snapshot, returns 1 on a miss
+    int Lookup(const SnapshotKey& Key, Snapshot& Snap);
+    // storing a snapshot, returns 1 if the file could not be written
+    int Store(const SnapshotKey& Key, const Snapshot& Snap);
+    // looking up the contract and computing and storing it on a miss
+    void Price(Option& Opt, BinModel Model, bool American, bool WithBoundary,
+               Snapshot& Snap);
+    // removing every stored snapshot whose key is not in Live,
+    // returns the number of files removed
+    int Prune(const std::vector<SnapshotKey>& Live);
+    int GetHits() { return Hits; }
+    int GetMisses() { return Misses; }
+    int GetInvalidated() { return Invalidated; }
+};
+#endif
@@ -0,0 +1,85 @@
+#include "SpotLadder.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    // value at S0 on a layer with stock prices Stock[0..n], interpolated
+    // linearly in log S between the nodes around S0
+    double AtSpot(const double* Stock, const double* Price, int n, double S0)
+    {
+        if (S0 <= Stock[0])
+            return Price[0];
+        if (S0 >= Stock[n])
+            return Price[n];
+        int i = int(upper_bound(Stock, Stock + n + 1, S0) - Stock) - 1;
+        if (Stock[i] == S0)
+            return Price[i];
+        double w = log(S0 / Stock[i]) / log(Stock[i + 1] / Stock[i]);
+        return (1 - w) * Price[i] + w * Price[i + 1];
+    }
+}
+
+int SpotLadder::Build(Option& Opt, BinModel Model, bool American)
+{
+    int N = Opt.GetN();
+    int k = Width;
+    if (k < 0 || Dates < 0 || Dates > N)
+        return 1;
+    double S0 = Model.GetS0();
+    // the same dividends 2k steps later, with the escrowed part of the
+    // extended root scaled so that today's middle node is S0
+    double PV = Model.DivPV(0);
+    BinModel Extended;
+    if (Extended.SetData((S0 - PV) / pow((1 + Model.GetU()) * (1 + Model.GetD()), k)
+                         + PV * pow(1 + Model.GetR(), -2 * k),
+                         Model.GetU(), Model.GetD(), Model.GetR()) == 1)
+        return 1;
+    for (const Dividend& d : Model.GetDividends())
+        if (Extended.AddDividend(d.n + 2 * k, d.Amount, d.Proportional) == 1)
+            return 1;
+    int Top = N + 2 * k;
+    double q = Extended.RiskNeutProb();
+    double Up = q / (1 + Extended.GetR()), Down = (1 - q) / (1 + Extended.GetR());
+    vector<double> Price(Top + 1), Stock(Top + 1), ExVal(Top + 1);
+    INSTR_COUNT(Allocations, 3);
+    Ahead.assign(Dates + 1, 0.0);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Extended.SLayer(Top, Stock.data());
+        Opt.PayoffBatch(Stock.data(), Price.data(), Top + 1);
+        INSTR_COUNT(PayoffEvals, Top + 1);
+    }
+    if (Dates == N)
+        Ahead[N] = AtSpot(Stock.data(), Price.data(), Top, S0);
+    {
+        INSTR_PHASE(InductionPhase);
+        // the layers before 2k are never needed, today is layer 2k
+        for (int n = Top - 1; n >= 2 * k; n--)
+        {
+            for (int i = 0; i <= n; i++)
+                Price[i] = Up * Price[i + 1] + Down * Price[i];
+            if (American || n - 2 * k <= Dates)
+                Extended.SLayer(n, Stock.data());
+            if (American)
+            {
+                Opt.PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+                for (int i = 0; i <= n; i++)
+                    Price[i] = max(Price[i], ExVal[i]);
+                INSTR_COUNT(PayoffEvals, n + 1);
+            }
+            if (n - 2 * k <= Dates)
+                Ahead[n - 2 * k] = AtSpot(Stock.data(), Price.data(), n, S0);
+        }
+        INSTR_COUNT(NodesVisited, ((unsigned long long)Top * (Top + 1) - 2ULL * k * (2 * k + 1)) / 2);
+    }
+    Spots.assign(Stock.begin(), Stock.begin() + 2 * k + 1);
+    Values.assign(Price.begin(), Price.begin() + 2 * k + 1);
+    // the middle rung is S0 exactly
+    Spots[k] = S0;
+    Ahead[0] = Values[k];
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef SpotLadder_hpp
+#define SpotLadder_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <vector>
+
+// Spot and theta ladder of one contract from a single backward induction.
+//
+// The lattice is started 2k steps before today from
+// S0/((1+U)(1+D))^k, so its layer 2k holds today's values at the 2k+1
+// spot levels S0((1+U)/(1+D))^j, j=-k..k, with S0 itself in the middle.
+// Layers 2k+m, m=1..Dates, are the same contract m steps later; the
+// value at S0 there is interpolated in log S between the two nodes
+// around it. The whole ladder costs one induction over N+2k steps.
+class SpotLadder
+{
+private:
+    int Width;
+    int Dates;
+    std::vector<double> Spots;  // 2k+1 spot levels of today
+    std::vector<double> Values; // today's values at Spots
+    std::vector<double> Ahead;  // Ahead[m], value at S0 m steps later
+public:
+    SpotLadder() : Width(5), Dates(0) { }
+    // k, giving 2k+1 spot levels
+    void SetWidth(int Width_) { Width = Width_; }
+    // number of later valuation dates, one per step
+    void SetDates(int Dates_) { Dates = Dates_; }
+    // running the extended induction, returns 1 if the model is not
+    // arbitrage-free or Dates exceeds N
+    int Build(Option& Opt, BinModel Model, bool American);
+    int GetWidth() { return Width; }
+    int GetDates() { return Dates; }
+    // spot level and value of rung j, j=-k..k
+    double Spot(int j) { return Spots[j + Width]; }
+    double Value(int j) { return Values[j + Width]; }
+    // value at S0 after m steps, m=0..Dates
+    double ValueAhead(int m) { return Ahead[m]; }
+    // change in value at S0 over the first m steps
+    double Theta(int m) { return Ahead[m] - Ahead[0]; }
+};
+#endif
@@ -0,0 +1,52 @@
+#include "StatePriceCache.hpp"
+#include "Instrumentation.hpp"
+#include <vector>
+using namespace std;
+
+void StatePriceCache::Build(BinModel Model_, int NMax_)
+{
+    Model = Model_;
+    NMax = NMax_;
+    States.assign((size_t)(NMax + 1) * (NMax + 2) / 2, 0.0);
+    INSTR_COUNT(Allocations, 1);
+    INSTR_PHASE(InductionPhase);
+    double q = Model.RiskNeutProb();
+    double Up = q / (1 + Model.GetR()), Down = (1 - q) / (1 + Model.GetR());
+    States[0] = 1.0;
+    for (int n = 0; n < NMax; n++)
+    {
+        const double* From = Layer(n);
+        double* To = States.data() + (size_t)(n + 1) * (n + 2) / 2;
+        // node (n+1,i) is reached by an up move from (n,i-1) and a down
+        // move from (n,i)
+        To[0] = Down * From[0];
+        for (int i = 1; i <= n; i++)
+            To[i] = Up * From[i - 1] + Down * From[i];
+        To[n + 1] = Up * From[n];
+    }
+    INSTR_COUNT(NodesVisited, (unsigned long long)NMax * (NMax + 1) / 2);
+}
+
+int StatePriceCache::Price(Option& Opt, double& Price)
+{
+    int N = Opt.GetN();
+    if (N > NMax || N < 0)
+        return 1;
+    thread_local vector<double> Stock, Pay;
+    Stock.resize(N + 1);
+    Pay.resize(N + 1);
+    Model.SLayer(N, Stock.data());
+    Opt.PayoffBatch(Stock.data(), Pay.data(), N + 1);
+    INSTR_COUNT(PayoffEvals, N + 1);
+    // four partial sums so that the loop vectorises without reassociating
+    const double* w = Layer(N);
+    double Sum[4] = {0.0, 0.0, 0.0, 0.0};
+    int i = 0;
+    for (; i + 4 <= N + 1; i += 4)
+        for (int k = 0; k < 4; k++)
+            Sum[k] += w[i + k] * Pay[i + k];
+    for (; i <= N; i++)
+        Sum[0] += w[i] * Pay[i];
+    Price = (Sum[0] + Sum[1]) + (Sum[2] + Sum[3]);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef StatePriceCache_hpp
+#define StatePriceCache_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+#include <cstddef>
+#include <vector>
+
+// Arrow-Debreu state prices of every node of one model up to NMax steps.
+//
+// The state price of node (n,i) is the value today of 1 paid at that
+// node only. One forward pass builds all of them; after that a European
+// contract expiring at any N <= NMax is the dot product of its payoff on
+// layer N with the state prices of that layer, so a grid of maturities
+// and strikes costs one pass plus O(N) per contract. The triangle takes
+// (NMax+1)(NMax+2)/2 doubles.
+class StatePriceCache
+{
+private:
+    BinModel Model;
+    int NMax;
+    std::vector<double> States; // layer n from offset n(n+1)/2
+public:
+    StatePriceCache() : NMax(-1) { }
+    void Build(BinModel Model_, int NMax_);
+    int GetNMax() { return NMax; }
+    // state prices of layer n, n+1 of them
+    const double* Layer(int n) { return States.data() + (std::size_t)n * (n + 1) / 2; }
+    // European price of Opt at its own N, returns 1 if N > NMax
+    int Price(Option& Opt, double& Price);
+};
+#endif
@@ -13,6 +13,17 @@ double Strangle::Payoff(double z)
         return z - K2;
 }
 
+// put leg plus call leg, equal to Payoff() as K1 < K2
+void Strangle::PayoffBatch(const double* z, double* Out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double PutLeg = z[i] <= K1 ? K1 - z[i] : 0.0;
+        double CallLeg = z[i] > K2 ? z[i] - K2 : 0.0;
+        Out[i] = PutLeg + CallLeg;
+    }
+}
+
 int Strangle::GetInputData()
 {
     cout << "Enter Strangle option data:" << endl;
@@ -0,0 +1,146 @@
+#include "TermBinModel.hpp"
+#include "OptionsEuropean.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+int TermBinModel::Fill()
+{
+    int N = R.size();
+    if (Lattice.SetData(S0, U, D, (U + D) / 2) == 1)
+        return 1;
+    Q.resize(N);
+    Disc.resize(N);
+    for (int n = 0; n < N; n++)
+    {
+        if (R[n] <= D || R[n] >= U)
+            return 1;
+        Q[n] = (R[n] - D) / (U - D);
+        Disc[n] = 1.0 / (1 + R[n]);
+    }
+    return 0;
+}
+
+int TermBinModel::SetData(double S0_, double U_, double D_, const vector<double>& R_)
+{
+    S0 = S0_;
+    U = U_;
+    D = D_;
+    R = R_;
+    Times.resize(R.size() + 1);
+    for (size_t n = 0; n < Times.size(); n++)
+        Times[n] = n;
+    return Fill();
+}
+
+int TermBinModel::SetCurves(double S0_, int N, const vector<double>& Ends,
+                            const vector<double>& Sigmas, const vector<double>& Rates)
+{
+    int K = Ends.size();
+    if (N < 1 || K < 1 || (int)Sigmas.size() != K || (int)Rates.size() != K)
+        return 1;
+    // cumulative variance and rate integral at the ends of the pieces
+    vector<double> Var(K + 1, 0.0), Int(K + 1, 0.0), Start(K + 1, 0.0);
+    for (int k = 0; k < K; k++)
+    {
+        double t0 = k > 0 ? Ends[k - 1] : 0.0;
+        if (Ends[k] <= t0 || Sigmas[k] < 0.0)
+            return 1;
+        Start[k + 1] = Ends[k];
+        Var[k + 1] = Var[k] + Sigmas[k] * Sigmas[k] * (Ends[k] - t0);
+        Int[k + 1] = Int[k] + Rates[k] * (Ends[k] - t0);
+    }
+    if (Var[K] <= 0.0)
+        return 1;
+    double h = sqrt(Var[K] / N);
+    S0 = S0_;
+    U = exp(h) - 1.0;
+    D = exp(-h) - 1.0;
+    // layer n sits where the variance reaches n/N of the total; the rate
+    // integral between two layers gives the step's R. Layer 0 is today even
+    // if the first pieces have no volatility, so the first step carries
+    // their rate. Layer N is the maturity, and likewise the last step
+    // carries the rate of any last pieces without volatility
+    Times.assign(N + 1, 0.0);
+    vector<double> RateInt(N + 1, 0.0);
+    int k = 0;
+    for (int n = 1; n < N; n++)
+    {
+        double v = Var[K] * n / N;
+        while (k < K - 1 && (Var[k + 1] < v || Sigmas[k] == 0.0))
+            k++;
+        double t = Start[k] + (v - Var[k]) / (Sigmas[k] * Sigmas[k]);
+        Times[n] = t;
+        RateInt[n] = Int[k] + Rates[k] * (t - Start[k]);
+    }
+    Times[N] = Ends[K - 1];
+    RateInt[N] = Int[K];
+    R.resize(N);
+    for (int n = 0; n < N; n++)
+        R[n] = exp(RateInt[n + 1] - RateInt[n]) - 1.0;
+    return Fill();
+}
+
+double EurOption::PriceByCRR(TermBinModel& Model)
+{
+    int N = GetN();
+    if (N > Model.GetN())
+        return NAN;
+    const double* Q = Model.GetQ();
+    const double* Disc = Model.GetDisc();
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    INSTR_COUNT(Allocations, 2);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            double Up = Disc[n] * Q[n], Down = Disc[n] * (1 - Q[n]);
+            for (int i = 0; i <= n; i++)
+                Price[i] = Up * Price[i + 1] + Down * Price[i];
+        }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+    }
+    return Price[0];
+}
+
+double AmOption::PriceBySnell(TermBinModel& Model)
+{
+    int N = GetN();
+    if (N > Model.GetN())
+        return NAN;
+    const double* Q = Model.GetQ();
+    const double* Disc = Model.GetDisc();
+    vector<double> Price(N + 1);
+    vector<double> Stock(N + 1);
+    vector<double> ExVal(N + 1);
+    INSTR_COUNT(Allocations, 3);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.SLayer(N, Stock.data());
+        PayoffBatch(Stock.data(), Price.data(), N + 1);
+        INSTR_COUNT(PayoffEvals, N + 1);
+    }
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            double Up = Disc[n] * Q[n], Down = Disc[n] * (1 - Q[n]);
+            Model.SLayer(n, Stock.data());
+            PayoffBatch(Stock.data(), ExVal.data(), n + 1);
+            for (int i = 0; i <= n; i++)
+                Price[i] = max(ExVal[i], Up * Price[i + 1] + Down * Price[i]);
+        }
+        INSTR_COUNT(NodesVisited, (unsigned long long)N * (N + 1) / 2);
+        INSTR_COUNT(PayoffEvals, (unsigned long long)N * (N + 1) / 2);
+    }
+    return Price[0];
+}
@@ -0,0 +1,51 @@
+#ifndef TermBinModel_hpp
+#define TermBinModel_hpp
+#include "BinModelEuropean.hpp"
+#include <vector>
+
+// Binomial model with a term structure of rates and volatility on a
+// recombining lattice.
+//
+// U and D are the same at every step. A volatility that changes in time
+// is met by steps of unequal length that each carry the same variance, a
+// rate that changes by the risk-neutral probability of each step,
+// q(n) = (R(n)-D)/(U-D). The probabilities and the discount factors
+// 1/(1+R(n)) are kept in contiguous arrays indexed by the step, which the
+// induction reads once per layer.
+class TermBinModel
+{
+private:
+    double S0;
+    double U;
+    double D;
+    BinModel Lattice; // the stock prices, its R is not used
+    std::vector<double> R;     // R[n], rate from step n to n+1
+    std::vector<double> Q;     // Q[n], risk-neutral probability of step n
+    std::vector<double> Disc;  // Disc[n] = 1/(1+R[n])
+    std::vector<double> Times; // Times[n], time of layer n in years
+    int Fill();
+public:
+    TermBinModel() : S0(0.0), U(0.0), D(0.0) { }
+    // per-step rates R_[0..N-1] with fixed U and D, one year per step;
+    // returns 1 if a step has D >= R or R >= U
+    int SetData(double S0_, double U_, double D_, const std::vector<double>& R_);
+    // N steps over piecewise constant volatility and continuously
+    // compounded short rate, Sigmas[k] and Rates[k] holding up to
+    // Ends[k] (increasing, the last being the maturity); returns 1 if
+    // the curves are invalid or a step is not arbitrage-free. A stretch
+    // with zero volatility, first, last or in between, adds no layers:
+    // the step across it carries its whole rate, which must stay below U
+    int SetCurves(double S0_, int N, const std::vector<double>& Ends,
+                  const std::vector<double>& Sigmas, const std::vector<double>& Rates);
+    int GetN() { return (int)R.size(); }
+    double S(int n, int i) { return Lattice.S(n, i); }
+    void SLayer(int n, double* Out) { Lattice.SLayer(n, Out); }
+    double GetS0() { return S0; }
+    double GetU() { return U; }
+    double GetD() { return D; }
+    double GetR(int n) { return R[n]; }
+    double GetTime(int n) { return Times[n]; }
+    const double* GetQ() { return Q.data(); }
+    const double* GetDisc() { return Disc.data(); }
+};
+#endif
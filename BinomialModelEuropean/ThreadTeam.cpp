@@ -0,0 +1,38 @@
+#include "ThreadTeam.hpp"
+#include <thread>
+#include <vector>
+using namespace std;
+
+void ThreadTeam::Run(const function<void(int)>& Body)
+{
+    Waiting = 0;
+    vector<thread> Workers;
+    for (int t = 1; t < Threads; t++)
+        Workers.push_back(thread(Body, t));
+    Body(0);
+    for (thread& w : Workers)
+        w.join();
+}
+
+void ThreadTeam::Barrier()
+{
+    if (Threads == 1)
+        return;
+    unique_lock<mutex> Guard(Lock);
+    long long Mine = Generation;
+    if (++Waiting == Threads)
+    {
+        Waiting = 0;
+        Generation++;
+        Wake.notify_all();
+        return;
+    }
+    Wake.wait(Guard, [&] { return Generation != Mine; });
+}
+
+void ThreadTeam::Split(int t, int Lo, int Hi, int& First, int& Last)
+{
+    long long Count = Hi - Lo + 1;
+    First = Lo + (int)(Count * t / Threads);
+    Last = Lo + (int)(Count * (t + 1) / Threads) - 1;
+}
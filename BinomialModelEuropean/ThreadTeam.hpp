@@ -0,0 +1,30 @@
+#ifndef ThreadTeam_hpp
+#define ThreadTeam_hpp
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// A fixed number of threads running one body, with a reusable barrier for
+// layer-by-layer work. Run() starts the team and returns when every
+// thread has finished; thread 0 is the calling thread.
+class ThreadTeam
+{
+private:
+    int Threads;
+    std::mutex Lock;
+    std::condition_variable Wake;
+    int Waiting;
+    long long Generation;
+public:
+    ThreadTeam() : Threads(1), Waiting(0), Generation(0) { }
+    void SetThreads(int Threads_) { Threads = Threads_ < 1 ? 1 : Threads_; }
+    int GetThreads() { return Threads; }
+    // running Body(t) for t = 0..Threads-1
+    void Run(const std::function<void(int)>& Body);
+    // waiting until every thread of the team has reached the barrier
+    void Barrier();
+    // the share First..Last of Lo..Hi taken by thread t, empty if
+    // First > Last
+    void Split(int t, int Lo, int Hi, int& First, int& Last);
+};
+#endif
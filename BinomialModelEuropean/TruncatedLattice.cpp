@@ -0,0 +1,156 @@
+#include "TruncatedLattice.hpp"
+#include "PayoffShape.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+double TruncatedLattice::Price(Option& Opt, BinModel Model, bool American)
+{
+    int N = Opt.GetN();
+    double q = Model.RiskNeutProb();
+    double R = Model.GetR();
+    double Disc = 1.0 / (1 + R);
+    PayoffShape Shape;
+    bool Shaped = GetPayoffShape(Opt, Shape) == 0;
+    double W = Shaped ? Width * sqrt(N * q * (1 - q)) : N + 1.0;
+
+    // leaves 0..LeafLo-1 lie strictly below the first break and leaves
+    // LeafHi..N strictly above the last one
+    vector<double> Price(N + 2);
+    vector<double> Stock(N + 1);
+    INSTR_COUNT(Allocations, 2);
+    int LeafLo = 0, LeafHi = N + 1;
+    if (Shaped)
+    {
+        Model.SLayer(N, Stock.data());
+        while (LeafLo <= N && Stock[LeafLo] < Shape.Breaks.front())
+            LeafLo++;
+        LeafHi = LeafLo;
+        while (LeafHi <= N && Stock[LeafHi] <= Shape.Breaks.back())
+            LeafHi++;
+    }
+    // a linear piece a + b S has the exact value (a + b F) (1+R)^-k, F
+    // the forward of S (S (1+R)^k without dividends), also under American
+    // exercise when early exercise never pays: b = 0 with a >= 0 (exercise
+    // now), or a <= 0 without dividends (never exercise before expiry)
+    int Last = Shape.A.size() - 1;
+    bool Divs = Model.HasDividends();
+    bool ExactLo = Shaped && (!American || (R >= 0 && ((Shape.A[0] <= 0 && !Divs) || (Shape.B[0] == 0 && Shape.A[0] >= 0))));
+    bool ExactHi = Shaped && (!American || (R >= 0 && ((Shape.A[Last] <= 0 && !Divs) || (Shape.B[Last] == 0 && Shape.A[Last] >= 0))));
+
+    auto BandLo = [&](int n)
+    {
+        int Lo = max(0, (int)ceil(n * q - W));
+        return ExactLo ? max(Lo, LeafLo - (N - n)) : Lo;
+    };
+    auto BandHi = [&](int n)
+    {
+        int Hi = min(n, (int)floor(n * q + W));
+        return ExactHi ? min(Hi, LeafHi - 1) : Hi;
+    };
+
+    // value of a node outside the band; the largest price and forward of
+    // a cut node go into the error bound
+    double MaxEdgeS = 0.0, MaxEdgeF = 0.0;
+    bool Cut = false;
+    auto Boundary = [&](int n, int i)
+    {
+        int k = N - n;
+        double s = Model.S(n, i);
+        int j;
+        if (ExactLo && i + k < LeafLo)
+            j = 0;
+        else if (ExactHi && i >= LeafHi)
+            j = Last;
+        else
+        {
+            double F = Model.Forward(n, s, N);
+            j = PieceOf(Shape, F);
+            MaxEdgeS = max(MaxEdgeS, s);
+            MaxEdgeF = max(MaxEdgeF, F);
+            Cut = true;
+        }
+        double v = Divs ? (Shape.A[j] + Shape.B[j] * Model.Forward(n, s, N)) * pow(Disc, k)
+                        : Shape.A[j] * pow(Disc, k) + Shape.B[j] * s;
+        return American ? max(v, Opt.Payoff(s)) : v;
+    };
+
+    Nodes = 0;
+    FullNodes = (long long)(N + 1) * (N + 2) / 2;
+    int Lo = BandLo(N), Hi = BandHi(N);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        if (Lo <= Hi)
+        {
+            Model.SRange(N, Lo, Hi - Lo + 1, Stock.data());
+            Opt.PayoffBatch(Stock.data(), Price.data() + Lo, Hi - Lo + 1);
+            Nodes += Hi - Lo + 1;
+            INSTR_COUNT(PayoffEvals, Hi - Lo + 1);
+        }
+    }
+    vector<double> ExVal;
+    if (American)
+        ExVal.resize(N + 1);
+    {
+        INSTR_PHASE(InductionPhase);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            int PrevLo = Lo, PrevHi = Hi;
+            Lo = BandLo(n);
+            Hi = BandHi(n);
+            if (Lo > Hi)
+                continue;
+            // children outside the band of layer n+1
+            int j = Lo;
+            for (; j <= Hi + 1 && j < PrevLo; j++)
+                Price[j] = Boundary(n + 1, j);
+            for (j = max(j, PrevHi + 1); j <= Hi + 1; j++)
+                Price[j] = Boundary(n + 1, j);
+
+            int Count = Hi - Lo + 1;
+            for (int i = Lo; i <= Hi; i++)
+                Price[i] = Disc * (q * Price[i + 1] + (1 - q) * Price[i]);
+            if (American)
+            {
+                Model.SRange(n, Lo, Count, Stock.data());
+                Opt.PayoffBatch(Stock.data(), ExVal.data(), Count);
+                for (int i = 0; i < Count; i++)
+                    Price[Lo + i] = max(Price[Lo + i], ExVal[i]);
+                INSTR_COUNT(PayoffEvals, Count);
+            }
+            Nodes += Count;
+            INSTR_COUNT(NodesVisited, Count);
+        }
+    }
+    double Result = Lo <= Hi ? Price[0] : Boundary(0, 0);
+
+    // The payoff differs from the piece a cut node takes by at most
+    // SpreadA + SpreadB S_T, so a European cut node is off by at most
+    // (SpreadA + SpreadB F) (1+R)^-(N-n), F its forward; discounted to the
+    // root that is (SpreadA + SpreadB F) (1+R)^-N. Without dividends and
+    // with R >= 0, (1+R)^-n S_n is a martingale under every stopping time,
+    // and an American cut node is off by at most twice SpreadA + SpreadB s,
+    // once for the piece and once for exercising on another piece. The
+    // lattice leaves the band with probability at most 2 exp(-2 W^2 / N).
+    ErrorBound = 0.0;
+    if (Cut)
+    {
+        double SpreadA = 0.0, SpreadB = 0.0;
+        for (int a = 0; a <= Last; a++)
+            for (int b = 0; b <= Last; b++)
+            {
+                SpreadA = max(SpreadA, fabs(Shape.A[a] - Shape.A[b]));
+                SpreadB = max(SpreadB, fabs(Shape.B[a] - Shape.B[b]));
+            }
+        double Tail = min(1.0, 2.0 * exp(-2.0 * W * W / N));
+        if (!American)
+            ErrorBound = Tail * (SpreadA + SpreadB * MaxEdgeF) * pow(Disc, N);
+        else if (!Divs && R >= 0)
+            ErrorBound = 2.0 * Tail * (SpreadA + SpreadB * MaxEdgeS);
+        else
+            ErrorBound = NAN;
+    }
+    return Result;
+}
@@ -0,0 +1,37 @@
+#ifndef TruncatedLattice_hpp
+#define TruncatedLattice_hpp
+#include "BinModelEuropean.hpp"
+#include "OptionsEuropean.hpp"
+
+// Backward induction over the active band of each layer only.
+//
+// Two kinds of nodes are left out. Nodes more than Width standard
+// deviations of the terminal index away from the mean path n*q are
+// reached with probability at most 2 exp(-2 W^2 / N) (Hoeffding's maximal
+// inequality, W the half-width in nodes); they get the value of the
+// payoff piece around their expected terminal price. Nodes all of whose
+// leaves lie inside the first or last linear piece of the payoff get
+// their exact value a (1+R)^-(N-n) + b S(n,i), so a digital or a spread
+// only needs the band around its strikes. User payoffs have no known
+// pieces and are priced on the full lattice.
+class TruncatedLattice
+{
+private:
+    double Width;
+    long long Nodes;
+    long long FullNodes;
+    double ErrorBound;
+public:
+    TruncatedLattice() : Width(6.0), Nodes(0), FullNodes(0), ErrorBound(0.0) { }
+    // half-width of the band in standard deviations
+    void SetWidth(double Width_) { Width = Width_; }
+    double Price(Option& Opt, BinModel Model, bool American);
+    // nodes evaluated and nodes of the full lattice in the last Price()
+    long long GetNodes() { return Nodes; }
+    long long GetFullNodes() { return FullNodes; }
+    // bound on the price error caused by the standard deviation cut in the
+    // last Price(); the payoff-flat cut is exact. NaN for an American
+    // contract with dividends or a negative rate, where none is known
+    double GetErrorBound() { return ErrorBound; }
+};
+#endif
@@ -0,0 +1,108 @@
+#include "TwoAssetModel.hpp"
+#include <iostream>
+#include <cmath>
+using namespace std;
+
+double TwoAssetModel::S1(int n, int i)
+{
+    return S10 * pow(1 + U1, i) * pow(1 + D1, n - i);
+}
+
+double TwoAssetModel::S2(int n, int j)
+{
+    return S20 * pow(1 + U2, j) * pow(1 + D2, n - j);
+}
+
+void TwoAssetModel::S1Layer(int n, double* Out)
+{
+    double Ratio = (1 + U1) / (1 + D1);
+    Out[0] = S1(n, 0);
+    for (int i = 1; i <= n; i++)
+        Out[i] = Out[i - 1] * Ratio;
+}
+
+void TwoAssetModel::S2Layer(int n, double* Out)
+{
+    double Ratio = (1 + U2) / (1 + D2);
+    Out[0] = S2(n, 0);
+    for (int j = 1; j <= n; j++)
+        Out[j] = Out[j - 1] * Ratio;
+}
+
+int TwoAssetModel::SetProbs()
+{
+    // making sure that 0<S0, -1<D<U, -1<R, -1<=Rho<=1 and D<R<U for both
+    if (S10 <= 0.0 || S20 <= 0.0 || D1 <= -1.0 || D2 <= -1.0 || U1 <= D1 ||
+        U2 <= D2 || R <= -1.0 || Rho < -1.0 || Rho > 1.0)
+        return 1;
+    if (R >= U1 || R <= D1 || R >= U2 || R <= D2)
+        return 1;
+    double q1 = (R - D1) / (U1 - D1), q2 = (R - D2) / (U2 - D2);
+    // the covariance of the two up-move indicators that gives correlation
+    // Rho between the one-step returns
+    double c = Rho * sqrt(q1 * (1 - q1) * q2 * (1 - q2));
+    Puu = q1 * q2 + c;
+    Pud = q1 * (1 - q2) - c;
+    Pdu = (1 - q1) * q2 - c;
+    Pdd = (1 - q1) * (1 - q2) + c;
+    if (Puu < 0.0 || Pud < 0.0 || Pdu < 0.0 || Pdd < 0.0)
+        return 1;
+    return 0;
+}
+
+int TwoAssetModel::GetInputData()
+{
+    // entering data
+    cout << "Enter S1(0): ";
+    cin >> S10;
+    cout << "Enter U1: ";
+    cin >> U1;
+    cout << "Enter D1: ";
+    cin >> D1;
+    cout << "Enter S2(0): ";
+    cin >> S20;
+    cout << "Enter U2: ";
+    cin >> U2;
+    cout << "Enter D2: ";
+    cin >> D2;
+    cout << "Enter R: ";
+    cin >> R;
+    cout << "Enter correlation Rho: ";
+    cin >> Rho;
+    cout << endl;
+    if (SetProbs() == 1)
+    {
+        cout << "Illegal data ranges, arbitrage or correlation" << endl;
+        cout << "Terminating program" << endl;
+        return 1;
+    }
+    cout << "Input data checked" << endl;
+    cout << "There is no arbitrage" << endl
+         << endl;
+    return 0;
+}
+
+int TwoAssetModel::SetData(double S10_, double U1_, double D1_, double S20_, double U2_,
+                           double D2_, double R_, double Rho_)
+{
+    S10 = S10_;
+    U1 = U1_;
+    D1 = D1_;
+    S20 = S20_;
+    U2 = U2_;
+    D2 = D2_;
+    R = R_;
+    Rho = Rho_;
+    return SetProbs();
+}
+
+int TwoAssetModel::SetCRRData(double S10_, double S20_, double Sigma1, double Sigma2,
+                              double Rho_, double r, double T, int N)
+{
+    if (Sigma1 <= 0.0 || Sigma2 <= 0.0 || T <= 0.0 || N <= 0)
+        return 1;
+    double dt = T / N;
+    return SetData(S10_, exp(Sigma1 * sqrt(dt)) - 1, exp(-Sigma1 * sqrt(dt)) - 1,
+                   S20_, exp(Sigma2 * sqrt(dt)) - 1, exp(-Sigma2 * sqrt(dt)) - 1,
+                   exp(r * dt) - 1, Rho_);
+}
@@ -0,0 +1,38 @@
+#ifndef TwoAssetModel_hpp
+#define TwoAssetModel_hpp
+// Two stocks on one recombining lattice. At each step stock k moves by
+// 1+Uk or 1+Dk; the marginal probabilities are the risk-neutral ones of
+// each stock, and the joint ones are tilted so that the moves have
+// correlation Rho.
+class TwoAssetModel
+{
+private:
+    double S10, U1, D1;
+    double S20, U2, D2;
+    double R;
+    double Rho;
+    double Puu, Pud, Pdu, Pdd; // first letter stock 1, second stock 2
+    int SetProbs();
+public:
+    // computing the stock prices after n steps with i (j) up moves
+    double S1(int n, int i);
+    double S2(int n, int j);
+    // computing S1(n,0),...,S1(n,n) (or S2) into Out
+    void S1Layer(int n, double* Out);
+    void S2Layer(int n, double* Out);
+    // inputting, displaying and checking model data
+    int GetInputData();
+    // setting and checking model data without console input, returns 1
+    // on illegal ranges, arbitrage or a correlation the lattice cannot hold
+    int SetData(double S10_, double U1_, double D1_, double S20_, double U2_,
+                double D2_, double R_, double Rho_);
+    // Cox-Ross-Rubinstein parameters for N steps over T years
+    int SetCRRData(double S10_, double S20_, double Sigma1, double Sigma2,
+                   double Rho_, double r, double T, int N);
+    double GetR() { return R; }
+    void GetProbs(double& Puu_, double& Pud_, double& Pdu_, double& Pdd_)
+    {
+        Puu_ = Puu; Pud_ = Pud; Pdu_ = Pdu; Pdd_ = Pdd;
+    }
+};
+#endif
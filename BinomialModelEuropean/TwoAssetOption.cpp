@@ -0,0 +1,162 @@
+#include "TwoAssetOption.hpp"
+#include "ThreadTeam.hpp"
+#include "Instrumentation.hpp"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+void TwoAssetOption::PayoffRow(double z1, const double* z2, double* Out, int n)
+{
+    for (int j = 0; j < n; j++)
+        Out[j] = Payoff(z1, z2[j]);
+}
+
+double TwoAssetOption::Induction(TwoAssetModel& Model, bool American)
+{
+    double Puu, Pud, Pdu, Pdd;
+    Model.GetProbs(Puu, Pud, Pdu, Pdd);
+    double Disc = 1.0 / (1 + Model.GetR());
+    Puu *= Disc;
+    Pud *= Disc;
+    Pdu *= Disc;
+    Pdd *= Disc;
+    int Stride = N + 1;
+    vector<double> Price((size_t)Stride * Stride);
+    vector<double> Stock1(N + 1), Stock2(N + 1);
+    INSTR_COUNT(Allocations, 3);
+    {
+        INSTR_PHASE(LeafInitPhase);
+        Model.S1Layer(N, Stock1.data());
+        Model.S2Layer(N, Stock2.data());
+        for (int i = 0; i <= N; i++)
+            PayoffRow(Stock1[i], Stock2.data(), Price.data() + (size_t)i * Stride, N + 1);
+        INSTR_COUNT(PayoffEvals, (unsigned long long)Stride * Stride);
+    }
+
+    ThreadTeam Team;
+    Team.SetThreads(min(Threads, N + 1));
+    Team.Run([&](int t)
+    {
+        INSTR_PHASE(InductionPhase);
+        vector<double> Halo(N + 1), ExVal(N + 1), Row2(N + 1);
+        for (int n = N - 1; n >= 0; n--)
+        {
+            int First, Last;
+            Team.Split(t, 0, n, First, Last);
+            if (First <= Last)
+                copy_n(Price.data() + (size_t)(Last + 1) * Stride, n + 2, Halo.data());
+            Team.Barrier();
+            if (American)
+                Model.S2Layer(n, Row2.data());
+            for (int i = First; i <= Last; i++)
+            {
+                double* Row = Price.data() + (size_t)i * Stride;
+                const double* Up = i == Last ? Halo.data() : Row + Stride;
+                // (i,j) from (i,j), (i+1,j), (i,j+1) and (i+1,j+1)
+                for (int j = 0; j <= n; j++)
+                    Row[j] = Pdd * Row[j] + Pud * Up[j] + Pdu * Row[j + 1] + Puu * Up[j + 1];
+                if (American)
+                {
+                    PayoffRow(Model.S1(n, i), Row2.data(), ExVal.data(), n + 1);
+                    for (int j = 0; j <= n; j++)
+                        Row[j] = max(Row[j], ExVal[j]);
+                }
+            }
+            if (First <= Last)
+            {
+                INSTR_COUNT(NodesVisited, (unsigned long long)(Last - First + 1) * (n + 1));
+                if (American)
+                    INSTR_COUNT(PayoffEvals, (unsigned long long)(Last - First + 1) * (n + 1));
+            }
+            Team.Barrier();
+        }
+    });
+    return Price[0];
+}
+
+double TwoAssetOption::PriceByCRR(TwoAssetModel Model)
+{
+    return Induction(Model, false);
+}
+
+double TwoAssetOption::PriceBySnell(TwoAssetModel Model)
+{
+    return Induction(Model, true);
+}
+
+int SpreadOption::GetInputData()
+{
+    cout << "Enter spread option data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter strike price K: ";
+    cin >> K;
+    cout << endl;
+    return 0;
+}
+
+double SpreadOption::Payoff(double z1, double z2)
+{
+    return max(z1 - z2 - K, 0.0);
+}
+
+void SpreadOption::PayoffRow(double z1, const double* z2, double* Out, int n)
+{
+    for (int j = 0; j < n; j++)
+        Out[j] = max(z1 - z2[j] - K, 0.0);
+}
+
+int BestOfCall::GetInputData()
+{
+    cout << "Enter best-of call data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter strike price K: ";
+    cin >> K;
+    cout << endl;
+    return 0;
+}
+
+double BestOfCall::Payoff(double z1, double z2)
+{
+    return max(max(z1, z2) - K, 0.0);
+}
+
+void BestOfCall::PayoffRow(double z1, const double* z2, double* Out, int n)
+{
+    for (int j = 0; j < n; j++)
+        Out[j] = max(max(z1, z2[j]) - K, 0.0);
+}
+
+int BasketCall::GetInputData()
+{
+    cout << "Enter basket call data:" << endl;
+    int N;
+    cout << "Enter steps to expiry N: ";
+    cin >> N;
+    SetN(N);
+    cout << "Enter weight W1: ";
+    cin >> W1;
+    cout << "Enter weight W2: ";
+    cin >> W2;
+    cout << "Enter strike price K: ";
+    cin >> K;
+    cout << endl;
+    return 0;
+}
+
+double BasketCall::Payoff(double z1, double z2)
+{
+    return max(W1 * z1 + W2 * z2 - K, 0.0);
+}
+
+void BasketCall::PayoffRow(double z1, const double* z2, double* Out, int n)
+{
+    for (int j = 0; j < n; j++)
+        Out[j] = max(W1 * z1 + W2 * z2[j] - K, 0.0);
+}
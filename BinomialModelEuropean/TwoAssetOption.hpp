@@ -0,0 +1,69 @@
+#ifndef TwoAssetOption_hpp
+#define TwoAssetOption_hpp
+#include "TwoAssetModel.hpp"
+
+// Option on two stocks priced on the two-asset lattice. Layer n holds
+// the (n+1) x (n+1) nodes (i,j), i up moves of stock 1 and j of stock 2,
+// as rows of one (N+1) x (N+1) buffer that every layer reuses in place.
+// Rows are split between threads; each thread keeps a copy of the row
+// above its share (the halo) because that row belongs to the next thread
+// and is overwritten in the same layer. The update of a row is a plain
+// loop over contiguous doubles, which the compiler vectorises at -O3.
+class TwoAssetOption
+{
+private:
+    int N; // steps to expiry
+    int Threads;
+    double Induction(TwoAssetModel& Model, bool American);
+public:
+    TwoAssetOption() : N(0), Threads(1) { }
+    virtual ~TwoAssetOption() { }
+    void SetN(int N_) { N = N_; }
+    int GetN() { return N; }
+    void SetThreads(int Threads_) { Threads = Threads_ < 1 ? 1 : Threads_; }
+    virtual double Payoff(double z1, double z2) { return 0.0; }
+    // payoff at (z1, z2[0]),...,(z1, z2[n-1]) into Out, one virtual call
+    // per row; the default calls Payoff() for each node
+    virtual void PayoffRow(double z1, const double* z2, double* Out, int n);
+    // pricing European option
+    double PriceByCRR(TwoAssetModel Model);
+    // pricing American option
+    double PriceBySnell(TwoAssetModel Model);
+};
+// max(z1 - z2 - K, 0)
+class SpreadOption : public TwoAssetOption
+{
+private:
+    double K;
+public:
+    void SetK(double K_) { K = K_; }
+    int GetInputData();
+    double Payoff(double z1, double z2);
+    void PayoffRow(double z1, const double* z2, double* Out, int n);
+};
+// max(max(z1, z2) - K, 0)
+class BestOfCall : public TwoAssetOption
+{
+private:
+    double K;
+public:
+    void SetK(double K_) { K = K_; }
+    int GetInputData();
+    double Payoff(double z1, double z2);
+    void PayoffRow(double z1, const double* z2, double* Out, int n);
+};
+// max(W1 z1 + W2 z2 - K, 0)
+class BasketCall : public TwoAssetOption
+{
+private:
+    double K;
+    double W1;
+    double W2;
+public:
+    void SetK(double K_) { K = K_; }
+    void SetWeights(double W1_, double W2_) { W1 = W1_; W2 = W2_; }
+    int GetInputData();
+    double Payoff(double z1, double z2);
+    void PayoffRow(double z1, const double* z2, double* Out, int n);
+};
+#endif